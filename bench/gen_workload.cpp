@@ -0,0 +1,106 @@
+// Synthetic trace generator for the benchmark suite.
+// Usage: gen_workload <sequential|strided|random|zipf|prodcons> <events> [seed] [processes]
+// Writes a trace in the REPL command syntax to stdout. About one event in ten is a
+// malloc or free, the rest are accesses (one in four of them a write).
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static const size_t HEAP = 65536;  // virtual heap of a MemoryManager
+static const size_t RAM = 16384;   // 64 frames of 256B: the heap does not fit
+static const size_t PAGE = 256;
+
+// Zipf(s) over n items by inverting the precomputed CDF
+class Zipf{
+private:
+    std::vector<double> cdf;
+
+public:
+    Zipf(size_t n, double s){
+        cdf.resize(n);
+        double sum = 0;
+        for(size_t i = 0; i < n; i++){
+            sum += 1.0 / std::pow((double)(i + 1), s);
+            cdf[i] = sum;
+        }
+        for(double& c : cdf) c /= sum;
+    }
+
+    size_t operator()(std::mt19937_64& rng){
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        size_t lo = 0, hi = cdf.size() - 1;
+        while(lo < hi){
+            size_t mid = (lo + hi) / 2;
+            if(cdf[mid] < u) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+};
+
+static void access(std::mt19937_64& rng, int pid, size_t address){
+    bool write = (rng() % 4 == 0);
+    std::cout << (write ? "write " : "access ") << pid << " " << std::hex << (address % HEAP) << std::dec << "\n";
+}
+
+int main(int argc, char* argv[]){
+    if(argc < 3){
+        std::cerr << "Usage: gen_workload <sequential|strided|random|zipf|prodcons> <events> [seed] [processes]\n";
+        return 1;
+    }
+    std::string kind = argv[1];
+    size_t events = std::strtoull(argv[2], nullptr, 10);
+    std::mt19937_64 rng(argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 42);
+    int processes = (argc > 4) ? std::atoi(argv[4]) : 8;
+    if(processes < 1) processes = 1;
+    if(kind != "sequential" && kind != "strided" && kind != "random" && kind != "zipf" && kind != "prodcons"){
+        std::cerr << "Error: Unknown workload " << kind << "\n";
+        return 1;
+    }
+
+    std::cout << "init " << RAM << "\n";
+    Zipf zipf(HEAP / PAGE, 1.0);
+    std::vector<size_t> cursor(processes + 1, 0); // next sequential / strided address per PID
+    if(kind == "prodcons"){
+        // Each producer PID p has a consumer thread 100 + p reading what it writes
+        for(int p = 1; p <= processes; p++) std::cout << "thread " << 100 + p << " " << p << "\n";
+    }
+
+    for(size_t i = 0; i < events; i++){
+        int pid = 1 + (int)(rng() % processes);
+
+        if(rng() % 10 == 0){
+            // Allocator churn: mostly small requests, a few large ones
+            if(rng() % 3 == 0) std::cout << "free " << pid << "\n";
+            else std::cout << "malloc " << (rng() % 8 == 0 ? 1024 + rng() % 4096 : 16 + rng() % 240) << " " << pid << "\n";
+            continue;
+        }
+
+        if(kind == "sequential"){
+            access(rng, pid, cursor[pid]);
+            cursor[pid] += 8;
+        }
+        else if(kind == "strided"){
+            access(rng, pid, cursor[pid]);
+            cursor[pid] += 272; // a page and a line apart, so every access lands on a new page
+        }
+        else if(kind == "random"){
+            access(rng, pid, rng() % HEAP);
+        }
+        else if(kind == "zipf"){
+            access(rng, pid, zipf(rng) * PAGE + rng() % PAGE);
+        }
+        else{
+            // The producer writes the next slot of its ring buffer, its consumer reads one behind
+            size_t slot = cursor[pid];
+            std::cout << "write " << pid << " " << std::hex << (slot % 8192) << std::dec << "\n";
+            if(slot >= 64) std::cout << "access " << 100 + pid << " " << std::hex << ((slot - 64) % 8192) << std::dec << "\n";
+            cursor[pid] += 64;
+        }
+    }
+    return 0;
+}
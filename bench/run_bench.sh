@@ -0,0 +1,85 @@
+#!/bin/bash
+# Simulator throughput benchmark. Run it through `make bench`, which builds the -O2
+# binaries first. Every workload is replayed under every allocator strategy, page
+# policy and cache configuration. The best of BENCH_REPEAT runs is kept.
+#   BENCH_EVENTS     events per generated workload        (default 100000)
+#   BENCH_REPEAT     runs per configuration                (default 3)
+#   BENCH_THRESHOLD  slowdown in % reported as regression  (default 15)
+#   BENCH_NO_COMPARE set to skip the baseline comparison   (make bench-baseline)
+# Results go to results/latest.csv and are compared with baseline.csv if it exists
+# (`make bench-baseline` saves the latest results as the baseline).
+cd "$(dirname "$0")" || exit 1
+
+EVENTS=${BENCH_EVENTS:-100000}
+REPEAT=${BENCH_REPEAT:-3}
+THRESHOLD=${BENCH_THRESHOLD:-15}
+WORKLOADS="sequential strided random zipf prodcons"
+STRATEGIES="first_fit best_fit worst_fit buddy slab"
+POLICIES="fifo lru clock"
+CACHE_NAMES="default large"
+LARGE_CACHES="inclusive 32768:64:8:4:lru 262144:64:16:12:srrip"
+
+mkdir -p traces results
+echo "Generating workloads ($EVENTS events each)..."
+for w in $WORKLOADS; do
+    ./gen_workload "$w" "$EVENTS" 42 > "traces/$w.txt" || exit 1
+done
+
+OUT=results/latest.csv
+echo "workload,strategy,policy,caches,events,ops_per_sec,ns_per_op,peak_rss_kb" > "$OUT"
+printf "%-11s %-10s %-6s %-8s %12s %10s %10s\n" workload strategy policy caches ops/sec ns/op rss_kb
+for w in $WORKLOADS; do
+for s in $STRATEGIES; do
+for p in $POLICIES; do
+for c in $CACHE_NAMES; do
+    best=""
+    for ((r = 0; r < REPEAT; r++)); do
+        if [ "$c" = "large" ]; then
+            report=$(./memsim_bench --replay "traces/$w.txt" --strategy "$s" --policy "$p" --caches "$LARGE_CACHES")
+        else
+            report=$(./memsim_bench --replay "traces/$w.txt" --strategy "$s" --policy "$p")
+        fi
+        # events elapsed_s peak_rss_kb
+        run=$(echo "$report" | awk '/^Events:/ {e=$2} /^Elapsed:/ {t=$2} /^Peak RSS:/ {m=$3} END {print e, t, m}')
+        if [ -z "$best" ] || awk -v a="$run" -v b="$best" 'BEGIN {split(a, x, " "); split(b, y, " "); exit !(x[2] < y[2])}'; then
+            best=$run
+        fi
+    done
+    read -r events elapsed rss <<< "$best"
+    row=$(awk -v e="$events" -v t="$elapsed" 'BEGIN {printf "%.0f,%.1f", e / t, t * 1e9 / e}')
+    echo "$w,$s,$p,$c,$events,$row,$rss" >> "$OUT"
+    printf "%-11s %-10s %-6s %-8s %12s %10s %10s\n" "$w" "$s" "$p" "$c" "${row%,*}" "${row#*,}" "$rss"
+done
+done
+done
+done
+
+if [ -n "$BENCH_NO_COMPARE" ]; then
+    exit 0
+fi
+if [ ! -f baseline.csv ]; then
+    echo "No baseline.csv to compare with (make bench-baseline saves one)."
+    exit 0
+fi
+
+echo
+echo "Compared with baseline.csv (ops/sec, regression beyond -$THRESHOLD%):"
+awk -F, -v threshold="$THRESHOLD" '
+    NR == FNR { if(FNR > 1) base[$1","$2","$3","$4] = $6; next }
+    FNR == 1 { next }
+    {
+        key = $1","$2","$3","$4
+        if(!(key in base) || base[key] == 0) { missing++; next }
+        change = ($6 / base[key] - 1) * 100
+        log_sum += log($6 / base[key]); count++
+        if(change < -threshold){
+            printf "  REGRESSION %-40s %12.0f -> %12.0f (%+.1f%%)\n", key, base[key], $6, change
+            regressions++
+        }
+    }
+    END {
+        if(count > 0) printf "  %d configurations, geometric mean change %+.1f%%\n", count, (exp(log_sum / count) - 1) * 100
+        if(missing > 0) printf "  %d configurations not in the baseline\n", missing
+        printf "  %d regressions\n", regressions
+        exit regressions > 0
+    }' baseline.csv "$OUT"
@@ -0,0 +1,94 @@
+#ifndef ADDRESS_SPACE_HPP
+#define ADDRESS_SPACE_HPP
+
+#include "BlockPool.hpp"
+#include "FreeBlockIndex.hpp"
+#include "BuddyAllocator.hpp"
+#include "SlabAllocator.hpp"
+#include <map>
+
+// Parsed once by set_strategy, so allocate does not compare strings
+enum class AllocStrategy { FirstFit, BestFit, WorstFit, Buddy, Slab };
+
+// Kind of a mapped range (VMA) of an address space
+enum class RegionKind { Heap, Mapping };
+
+struct Region{
+    size_t start;
+    size_t size;
+    RegionKind kind;
+};
+
+// One virtual address space: a tree of its mapped regions by start address, and the
+// block list of its heap region, which starts at 0.
+//  - Shared mode puts every PID in one space whose heap is fixed at 64 KB.
+//  - Private mode gives each process its own sparse space. Its heap doubles when a
+//    malloc does not fit, and large mallocs get a Mapping region of their own,
+//    placed top-down from the top of the space with a guard page below each.
+class AddressSpace{
+private:
+    BlockPool& pool;  // list nodes, shared by every space
+    std::map<size_t, Region> regions;
+    size_t top;       // end of the usable range
+    size_t guard;     // one page, kept unmapped below every Mapping
+    bool growable;
+    AllocStrategy strategy;
+
+    size_t heap_limit() const; // the heap may grow up to here
+
+public:
+    //The heap region [0, heap_size): its free blocks are indexed by free_index,
+    //or owned by buddy while the strategy is Buddy
+    MemoryBlock* head;
+    size_t heap_size;  // always a power of two, as the buddy engine needs
+    size_t heap_used = 0;     // bytes in allocated blocks
+    size_t mapped_bytes = 0;  // in Mapping regions
+    FreeBlockIndex free_index;
+    BuddyAllocator* buddy = nullptr;  // created when the space first runs Buddy
+    SlabAllocator* slabs = nullptr;   // created by the first small malloc under Slab
+
+    //Compaction of this heap
+    bool compacting = false;       // an incremental pass is in progress
+    size_t compact_cursor = 0;     // the heap below is packed, apart from later frees
+    double pass_fragmentation = 0; // when the pass started
+    size_t heap_changes = 0;       // successful mallocs and frees
+    size_t last_pass_changes = (size_t)-1; // heap_changes when the last pass ended
+
+    //This space's share of MemoryManager's totals, as last counted
+    struct Footprint{
+        size_t heap_size = 0;
+        size_t heap_used = 0;
+        size_t mapped_bytes = 0;
+        size_t mappings = 0;
+        size_t free_blocks = 0;
+        size_t largest_free = 0;
+    };
+    Footprint counted;
+
+    AddressSpace(BlockPool& node_pool, size_t initial_heap, size_t address_top, size_t page_size,
+                 bool can_grow, AllocStrategy alloc_strategy);
+    ~AddressSpace(); // hands every list node back to the pool, unless abandon_nodes came first
+    void abandon_nodes() { head = nullptr; } // the pool is going too and frees them wholesale
+    AddressSpace(const AddressSpace&) = delete;
+    AddressSpace& operator=(const AddressSpace&) = delete;
+
+    //Heap blocks (Slab uses First Fit here)
+    MemoryBlock* take_block(size_t size);      // allocated block of the list, nullptr if none fits
+    void release_block(MemoryBlock* block);    // frees and coalesces
+    bool grow(size_t size);                    // doubles the heap until size fits at its end; false if it cannot
+    void set_strategy(AllocStrategy next);     // hands the free blocks over between index and buddy engine
+    void swap_with_gap(MemoryBlock* gap, MemoryBlock* block); // [gap][block] -> [block][gap], for compaction
+
+    size_t largest_free() const;
+    size_t free_count() const;
+    double fragmentation() const; // external, percent
+
+    //Regions
+    size_t map(size_t size);           // start of a new Mapping of size bytes (page-rounded), INVALID if no room
+    size_t unmap(size_t start);        // size of the Mapping removed, 0 if none starts there
+    const Region* find(size_t address) const; // region holding address, nullptr if unmapped
+    const std::map<size_t, Region>& get_regions() const { return regions; }
+    static const size_t INVALID = (size_t)-1;
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef BLOCK_POOL_HPP
+#define BLOCK_POOL_HPP
+
+#include "MemoryBlock.hpp"
+#include <vector>
+#include <utility>
+
+// Slab of MemoryBlock nodes for the virtual heap list.
+// Nodes are carved from contiguous chunks (each twice as large as the last, up to
+// MAX_CHUNK nodes), and released nodes go onto an intrusive free list threaded
+// through their `next` pointer, so splits and merges never touch the global heap.
+// MemoryBlock is trivially destructible: the pool frees its chunks wholesale
+// without visiting the nodes.
+class BlockPool{
+private:
+    static const size_t FIRST_CHUNK = 64;
+    static const size_t MAX_CHUNK = 16384;
+
+    std::vector<std::pair<MemoryBlock*, size_t>> chunks; // storage and node count
+    MemoryBlock* free_list = nullptr;
+    size_t used_in_last = 0; // nodes handed out so far from the newest chunk
+
+    void grow();
+
+public:
+    BlockPool() = default;
+    ~BlockPool(); // releases every node, live or not
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    MemoryBlock* create(size_t addr, size_t sz, bool free = true, int pid = -1);
+    void destroy(MemoryBlock* block);
+};
+
+#endif
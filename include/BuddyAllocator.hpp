@@ -0,0 +1,62 @@
+#ifndef BUDDY_ALLOCATOR_HPP
+#define BUDDY_ALLOCATOR_HPP
+
+#include "BlockPool.hpp"
+#include <vector>
+#include <cstdint>
+
+// Buddy engine for the virtual heap. It works directly on the MemoryBlock list:
+// every free block it owns is an aligned power-of-two block, linked into the
+// free list of its order and marked in the free bitmap.
+class BuddyAllocator{
+private:
+    size_t heap_size; // must be a power of two
+    int max_order;    // heap_size == 1 << max_order
+    BlockPool& pool;  // where split and merged list nodes come from and go
+
+    std::vector<MemoryBlock*> free_lists; // one list head per order
+    size_t free_count = 0; // blocks on all lists
+
+    // One bit per possible block of each order: set if that block is free.
+    // Bit for (order, addr) is at order_offset[order] + (addr >> order)
+    std::vector<uint64_t> free_bitmap;
+    std::vector<size_t> order_offset;
+
+    void layout_bitmap(); // one bit per possible block of every order, all clear
+    bool test_bit(int order, size_t addr) const;
+    void set_bit(int order, size_t addr, bool value);
+
+    void push_free(MemoryBlock* block, int order);
+    void remove_free(MemoryBlock* block, int order);
+
+    // Splits off everything above lower_size into a new free list node
+    MemoryBlock* split(MemoryBlock* block, size_t lower_size);
+    // Coalesces an aligned free block with its buddies and files it
+    MemoryBlock* release_aligned(MemoryBlock* block);
+
+public:
+    BuddyAllocator(size_t heap_sz, BlockPool& node_pool);
+    ~BuddyAllocator() = default;
+
+    static int order_of(size_t size); // smallest order whose block holds size bytes
+
+    // Returns an allocated block of size next_power_of_two(request), or nullptr
+    MemoryBlock* allocate(size_t request_size);
+
+    // Returns a freed block to the engine. Blocks that are not aligned powers of two
+    // (left over from a fit strategy) are carved into aligned pieces first.
+    // Returns the free block that now covers the end of the freed range.
+    MemoryBlock* release(MemoryBlock* block);
+
+    // Forgets all free blocks (the list nodes themselves stay untouched)
+    void clear();
+
+    // The heap now ends at new_heap_size, a larger power of two. The caller appends
+    // the new range to the list as one block and hands it over with release().
+    void grow(size_t new_heap_size);
+
+    size_t count() const { return free_count; }
+    size_t largest() const; // size of the largest free block, 0 if none
+};
+
+#endif
@@ -1,41 +1,60 @@
 #ifndef CACHE_HPP
 #define CACHE_HPP
 
-#include <vector>
-#include <list>
-#include <cmath>
-#include <iostream>
-#include <iomanip>
+#include <string>
+#include <cstddef>
 
-class Cache{
-private:
-    struct CacheLine{
-        size_t tag;
-        bool valid;
-    };
-    
-    // A set contains multiple ways(lines) and a replacement queue
-    struct CacheSet{
-        std::vector<CacheLine> lines;
-        std::list<size_t> fifo_queue; 
-    };
-
-    size_t cache_size;
-    size_t block_size;
-    size_t associativity; // K-way
-    size_t num_sets;
-
-    std::vector<CacheSet> sets;
-
-    //Stats
-    long long hits = 0;
-    long long misses = 0;
+enum class CachePolicy { FIFO, LRU, PLRU, SRRIP, BRRIP };
 
-public:
-    Cache(size_t size, size_t block_sz, size_t assoc);
+// MESI state of a line. Outside multi-core mode lines are only ever Exclusive or Modified.
+enum class LineState : uint8_t { Invalid, Shared, Exclusive, Modified };
 
-    bool access(size_t address);
-    void display_stats();
+// Line pushed out by a fill
+struct CacheVictim{
+    bool valid;     // false if the fill used an empty way
+    size_t address; // first byte of the evicted line
+    bool dirty;
+    bool prefetched; // brought in by a prefetch and never used
 };
 
-#endif
\ No newline at end of file
+// One level of physically indexed, set-associative cache.
+// Built with make_cache(), which picks a compile-time specialized
+// implementation when the geometry is one of the built-in shapes.
+// Only lookup() counts as an access in the hit/miss stats.
+class Cache{
+public:
+    virtual ~Cache() = default;
+
+    virtual bool lookup(size_t address, bool mark_dirty) = 0; // true on hit, which updates replacement state
+    virtual CacheVictim fill(size_t address, bool dirty, bool prefetched = false) = 0; // installs a line that is not present
+    virtual bool claim_prefetched(size_t address) = 0;        // clears the line's prefetch mark, true if it had one
+    virtual bool contains(size_t address) const = 0;
+    virtual bool set_dirty(size_t address) = 0;               // false if the line is not present
+    virtual bool invalidate(size_t address, bool& was_dirty) = 0; // false if the line is not present
+    virtual LineState state_of(size_t address) const = 0;        // Invalid if not present
+    virtual bool set_state(size_t address, LineState state) = 0; // false if the line is not present
+    virtual void display_stats() = 0;
+
+    // Read with fill on miss
+    bool access(size_t address){
+        if(lookup(address, false)) return true;
+        fill(address, false);
+        return false;
+    }
+
+    virtual size_t get_size() const = 0;
+    virtual size_t get_block_size() const = 0;
+    virtual size_t get_associativity() const = 0;
+    virtual const char* get_policy_name() const = 0;
+    virtual long long get_hits() const = 0;
+    virtual long long get_misses() const = 0;
+
+    // "fifo", "lru", "plru" (tree pseudo-LRU), "srrip" or "brrip"
+    static bool is_policy(const std::string& policy_name);
+    static CachePolicy parse_policy(const std::string& policy_name); // FIFO if unknown
+    static const char* policy_name(CachePolicy policy);
+};
+
+Cache* make_cache(size_t size, size_t block_sz, size_t assoc, const std::string& policy_name = "fifo");
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef CACHE_HIERARCHY_HPP
+#define CACHE_HIERARCHY_HPP
+
+#include "Cache.hpp"
+#include "Prefetcher.hpp"
+#include <vector>
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+
+// How the contents of the levels relate to each other
+enum class CacheInclusion { NonInclusive, Inclusive, Exclusive };
+
+struct CacheLevelConfig{
+    size_t size;
+    size_t block_size;
+    size_t assoc;
+    unsigned long long latency; // cycles to look this level up
+    std::string policy = "fifo";
+    bool write_back = true;     // false: write-through, no write-allocate
+    std::string prefetcher;     // make_prefetcher name, empty for none
+    size_t prefetch_degree = 0; // 0: the prefetcher's default
+    size_t prefetch_distance = 0;
+};
+
+// L1 (index 0) down to the last level, then DRAM.
+//  - Write-back levels allocate on writes and keep dirty lines until they are evicted.
+//  - Write-through levels forward every write to the next level, and only allocate
+//    on a write miss when inclusion requires it.
+//  - Inclusive: evicting a line from a lower level invalidates it in every level above.
+//  - Exclusive: a line lives in one level. Misses fill L1 only, hits below L1 move the
+//    line up, and each level's victims drop into the level below.
+// Write-backs and write-throughs are buffered: they are counted as traffic, not cycles.
+//
+// With several cores, every core has a private copy of L1 and the levels below are shared.
+// The L1s are kept coherent with MESI by snooping the other cores on L1 misses and
+// on writes to Shared lines:
+//  - a read miss takes a Modified line straight from its owner (a cache-to-cache
+//    transfer, which also writes it back below) and leaves both copies Shared;
+//    clean data comes from the shared levels, as Shared if a peer holds it, else Exclusive;
+//  - a write invalidates every peer copy, taking a Modified one over cache-to-cache.
+//
+// A level with a prefetcher shows it the demand accesses that reach the level. Each line
+// it names is brought in like a read miss (from the first level below holding it, or DRAM,
+// filling the levels between), after the access, and marked as prefetched in this level.
+// The fetch takes the usual cycles, off the critical path: a demand access that uses the
+// line before they are over waits for the rest (a late prefetch). Prefetches never snoop,
+// so a line some other core holds is not prefetched. Exclusive hierarchies cannot prefetch.
+class CacheHierarchy{
+private:
+    struct Level{
+        std::vector<Cache*> caches; // one per core for L1 in multi-core mode, otherwise one
+        CacheLevelConfig config;
+        size_t writebacks = 0;        // dirty lines evicted from this level
+        size_t write_throughs = 0;    // writes forwarded to the level below
+        size_t back_invalidations = 0; // lines dropped to keep an inclusive hierarchy
+
+        //Prefetching, none if prefetchers is empty
+        struct Arrival{
+            unsigned long long at; // cycle the prefetch is in
+            bool from_dram;
+        };
+        //Lines a prefetch fill evicted, at most as many as the copy holds: line -> its entry in order
+        struct Displaced{
+            std::unordered_map<size_t, size_t> lines;
+            std::deque<std::pair<size_t, size_t>> order; // (line, entry), oldest first
+            size_t entries = 0;
+        };
+        std::vector<Prefetcher*> prefetchers; // one per copy of the level
+        std::vector<std::unordered_map<size_t, Arrival>> arrivals; // per copy: prefetched lines not used yet
+        std::vector<Displaced> displaced; // per copy, in every level once any level prefetches
+        size_t prefetches = 0;        // lines brought in by the prefetcher
+        size_t useful_prefetches = 0; // of them, used by a demand access
+        size_t late_prefetches = 0;   // used before they had arrived
+        size_t unused_prefetches = 0; // evicted or invalidated without being used
+        size_t pollution_misses = 0;  // demand misses on lines a prefetch fill evicted
+        unsigned long long late_cycles = 0; // demand accesses waiting for late prefetches
+        size_t prefetch_dram_bytes = 0; // DRAM reads the prefetches issued
+        size_t unused_dram_bytes = 0;   // of them, for lines never used
+    };
+
+    std::vector<Level> levels;
+    CacheInclusion inclusion;
+    unsigned long long dram_latency;
+    size_t cores;
+    size_t core = 0; // core of the access in progress
+
+    int last_level = 0; // level that served the last access, levels.size() for DRAM, -1 if none was needed
+    int last_supplier = -1; // core whose L1 supplied the last access, or -1
+    bool prefetching = false; // some level has a prefetcher
+    bool in_prefetch = false; // the fills now are a prefetch's: their victims are displaced
+    unsigned long long now = 0; // cycles of all accesses so far, the prefetch clock
+    std::vector<size_t> candidates;
+
+    //Coherence
+    size_t invalidations = 0;    // peer copies dropped by writes
+    size_t upgrades = 0;         // writes to Shared lines
+    size_t cache_to_cache = 0;   // Modified lines handed over between L1s
+    size_t false_sharing = 0;    // invalidations of copies that never touched the written word
+
+    // Per L1 line: the words each core touched since its copy was loaded, and the damage done
+    struct LineSharing{
+        std::vector<uint64_t> words; // bit w set: core touched word w of the line
+        size_t invalidations = 0;
+        size_t false_sharing = 0;
+    };
+    std::unordered_map<size_t, LineSharing> sharing;
+
+    //DRAM traffic
+    size_t dram_reads = 0;
+    size_t dram_writes = 0;
+    size_t dram_read_bytes = 0;
+    size_t dram_write_bytes = 0;
+    size_t pollution_dram_bytes = 0; // demand reads a line displaced by a prefetch would have served
+
+    static const size_t WORD_SIZE = 8; // bytes carried by one write-through store
+
+    size_t copy_at(size_t level) const { return level == 0 ? core : 0; }
+    Cache* cache_at(size_t level) const { return levels[level].caches[copy_at(level)]; }
+    bool allocates(size_t level, bool write) const;
+    bool snoop(size_t address, bool write, bool& shared); // true if a peer supplied the line
+    LineSharing& note_access(size_t address);
+    void install(size_t level, size_t address, bool dirty, bool prefetched = false);
+    void evict(size_t level, const CacheVictim& victim);
+    void write_down(size_t level, size_t address, size_t bytes);
+    unsigned long long use_prefetch(size_t level, size_t address, unsigned long long at); // cycles waited
+    void run_prefetchers(size_t address, size_t looked_up, size_t hit, int used_level, unsigned long long at);
+    void prefetch(size_t level, size_t address, unsigned long long at);
+    void unused_prefetch(size_t level, size_t copy, size_t address);
+    bool drop(size_t level, size_t copy, size_t address, bool& was_dirty); // invalidates one copy's line
+    void displace(size_t level, size_t copy, size_t address);
+    bool polluted(size_t level, size_t address); // true for a miss on a displaced line
+
+public:
+    // Exclusive hierarchies are single-core only
+    CacheHierarchy(const std::vector<CacheLevelConfig>& configs, CacheInclusion mode, unsigned long long dram_cycles,
+                   size_t core_count = 1);
+    ~CacheHierarchy();
+    CacheHierarchy(const CacheHierarchy&) = delete;
+    CacheHierarchy& operator=(const CacheHierarchy&) = delete;
+
+    // Returns the cycles the access took
+    unsigned long long access(size_t address, bool write, size_t on_core = 0);
+    // Drops every line of a physical range from every level and core, dirty or not
+    // (the data there is stale, e.g. moved by compaction). Returns the lines dropped.
+    size_t invalidate_range(size_t address, size_t bytes);
+    // Contents, for invariant checks: whether a level (any core's copy of L1) holds the
+    // line of address, and the MESI state of one core's L1 copy
+    bool holds(size_t level, size_t address) const;
+    LineState l1_state(size_t on_core, size_t address) const { return levels[0].caches[on_core]->state_of(address); }
+    size_t core_count() const { return cores; }
+    int get_last_level() const { return last_level; }
+    int get_last_supplier() const { return last_supplier; }
+    size_t level_count() const { return levels.size(); }
+    void set_dram_latency(unsigned long long cycles) { dram_latency = cycles; }
+
+    void display_stats();
+    double hit_ratio(size_t level) const; // percent, over all copies of the level
+    long long level_hits(size_t level) const;
+    long long level_misses(size_t level) const;
+    size_t get_dram_read_bytes() const { return dram_read_bytes; }
+    size_t get_dram_write_bytes() const { return dram_write_bytes; }
+    // DRAM traffic of prefetching: all reads the prefetches issued (included in the DRAM
+    // read bytes), and the part of it that was extra: reads for prefetched lines never
+    // used, plus demand reads that a line a prefetch had evicted would have served
+    size_t get_prefetch_dram_bytes() const;
+    size_t get_unused_prefetch_bytes() const;
+    size_t get_pollution_dram_bytes() const { return pollution_dram_bytes; }
+    size_t prefetches(size_t level) const { return levels[level].prefetches; }
+    size_t useful_prefetches(size_t level) const { return levels[level].useful_prefetches; }
+    size_t late_prefetches(size_t level) const { return levels[level].late_prefetches; }
+    // Percent of prefetched lines used, and of the level's would-be misses they removed
+    static double prefetch_accuracy(size_t issued, size_t useful);
+    static double prefetch_coverage(size_t useful, long long misses);
+
+    static std::vector<CacheLevelConfig> default_levels(); // 128B 2-way L1, 512B 4-way L2
+    // "size:block:assoc:latency[:policy][:wb|wt][:prefetcher]", e.g. "32768:64:8:4:lru:wb:stream/2/8"
+    // (prefetcher as parse_prefetcher)
+    static bool parse_level(const std::string& spec, CacheLevelConfig& config);
+    // "inclusive", "exclusive" or "non_inclusive"
+    static bool parse_inclusion(const std::string& name, CacheInclusion& mode);
+    static const char* inclusion_name(CacheInclusion mode);
+    // Level specs separated by spaces or commas, optionally preceded by an inclusion mode
+    // (non_inclusive by default), e.g. "inclusive 128:16:2:4 512:16:4:12 4096:64:8:30:lru"
+    static bool parse_config(const std::string& text, std::vector<CacheLevelConfig>& levels, CacheInclusion& mode);
+    // Inclusive hierarchies need block sizes that never shrink going down, exclusive ones need
+    // one block size and no prefetchers
+    static bool valid_config(const std::vector<CacheLevelConfig>& levels, CacheInclusion mode);
+};
+
+#endif
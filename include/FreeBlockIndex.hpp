@@ -0,0 +1,57 @@
+#ifndef FREE_BLOCK_INDEX_HPP
+#define FREE_BLOCK_INDEX_HPP
+
+#include "MemoryBlock.hpp"
+#include <map>
+#include <utility>
+
+// Index of the FREE blocks of the virtual heap, kept alongside the linked list.
+// A block must be erased before its address/size is changed and re-inserted after.
+class FreeBlockIndex{
+private:
+    // Treap ordered by address. Each node also stores the largest block size
+    // in its subtree, so First Fit can skip whole subtrees that are too small.
+    struct Node{
+        size_t address;
+        size_t size;
+        size_t max_size; // largest size in this subtree
+        unsigned priority;
+        MemoryBlock* block;
+        Node* left;
+        Node* right;
+    };
+
+    Node* root = nullptr;
+    unsigned rng_state = 2463534242u;
+
+    // Ordered by (size, address) for Best Fit / Worst Fit
+    std::map<std::pair<size_t, size_t>, MemoryBlock*> by_size;
+
+    unsigned next_priority();
+    static size_t max_of(Node* node);
+    static void update(Node* node);
+    static void split(Node* node, size_t address, Node*& left, Node*& right); // left: < address
+    static Node* merge(Node* left, Node* right);
+    static void destroy(Node* node);
+
+public:
+    FreeBlockIndex() = default;
+    ~FreeBlockIndex();
+    FreeBlockIndex(const FreeBlockIndex&) = delete;
+    FreeBlockIndex& operator=(const FreeBlockIndex&) = delete;
+
+    void insert(MemoryBlock* block);
+    void erase(MemoryBlock* block);
+    void clear();
+
+    //Each returns nullptr if no free block is large enough
+    MemoryBlock* first_fit(size_t size) const; // lowest address with size >= request
+    MemoryBlock* best_fit(size_t size) const;  // smallest size >= request, lowest address on ties
+    MemoryBlock* worst_fit(size_t size) const; // largest size, lowest address on ties
+    MemoryBlock* first_from(size_t address) const; // lowest address >= address, any size
+
+    size_t count() const { return by_size.size(); }
+    size_t largest() const { return by_size.empty() ? 0 : by_size.rbegin()->first.first; }
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Timing of the simulator's own hot paths: a call counter and a log2 histogram
+// of time stamp counter ticks per probe. Build with -DMEMSIM_NO_INSTRUMENTATION
+// (make NO_INSTRUMENTATION=1) and the probes compile to nothing.
+enum class Probe { Allocate, Deallocate, Translate, FrameAlloc, CacheAccess, Compact, Count };
+
+class Instrumentation{
+public:
+    static const int BUCKETS = 40; // bucket b: ticks in [2^(b-1), 2^b)
+
+private:
+    struct ProbeStats{
+        uint64_t calls = 0;
+        uint64_t total_ticks = 0;
+        uint64_t min_ticks = UINT64_MAX;
+        uint64_t max_ticks = 0;
+        uint64_t histogram[BUCKETS] = {};
+    };
+
+    ProbeStats probes[(int)Probe::Count];
+
+    //Taken at construction, so the tick rate can be measured against the steady clock
+    uint64_t start_ticks;
+    std::chrono::steady_clock::time_point start_time;
+
+public:
+    Instrumentation();
+
+    static uint64_t ticks(){
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+
+    void record(Probe probe, uint64_t elapsed){
+        ProbeStats& p = probes[(int)probe];
+        p.calls++;
+        p.total_ticks += elapsed;
+        if(elapsed < p.min_ticks) p.min_ticks = elapsed;
+        if(elapsed > p.max_ticks) p.max_ticks = elapsed;
+        int bucket = (elapsed == 0) ? 0 : 64 - __builtin_clzll(elapsed);
+        p.histogram[bucket < BUCKETS ? bucket : BUCKETS - 1]++;
+    }
+
+    static bool enabled();
+    static const char* probe_name(Probe probe);
+    double ticks_per_ns() const; // measured since construction
+    double mean_ns(Probe probe) const; // 0 if never called
+
+    //The "instrumentation" object of the stats JSON
+    void write_json(std::ostream& out) const;
+};
+
+// Times the enclosing scope
+class ScopedProbe{
+private:
+    Instrumentation& target;
+    Probe probe;
+    uint64_t start;
+
+public:
+    ScopedProbe(Instrumentation& instrumentation, Probe which)
+        : target(instrumentation), probe(which), start(Instrumentation::ticks()) {}
+    ~ScopedProbe() { target.record(probe, Instrumentation::ticks() - start); }
+};
+
+#ifndef MEMSIM_NO_INSTRUMENTATION
+#define MEMSIM_PROBE(instrumentation, probe) ScopedProbe memsim_probe(instrumentation, probe)
+#else
+#define MEMSIM_PROBE(instrumentation, probe) ((void)0)
+#endif
+
+#endif
@@ -12,9 +12,13 @@ struct MemoryBlock{
     MemoryBlock* next; // Pointer to the next block in memory
     MemoryBlock* prev; // Pointer to the previous block in memory
 
+    MemoryBlock* next_free; // Links within the buddy allocator's per-order free list
+    MemoryBlock* prev_free;
+
     // Constructor to initialize a block easily
     MemoryBlock(size_t addr, size_t sz, bool free = true, int pid = -1)
-        : start_address(addr), size(sz), is_free(free), process_id(pid), next(nullptr), prev(nullptr) {}
+        : start_address(addr), size(sz), is_free(free), process_id(pid), next(nullptr), prev(nullptr),
+          next_free(nullptr), prev_free(nullptr) {}
 };
 
 #endif
\ No newline at end of file
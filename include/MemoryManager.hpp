@@ -2,27 +2,191 @@
 #define MEMORY_MANAGER_HPP
 
 #include "MemoryBlock.hpp"
-#include "Cache.hpp"
+#include "BlockPool.hpp"
+#include "CacheHierarchy.hpp"
+#include "Scheduler.hpp"
 #include "PageTable.hpp"
+#include "TLB.hpp"
+#include "ReplacementPolicy.hpp"
+#include "ReuseProfiler.hpp"
+#include "Instrumentation.hpp"
+#include "AddressSpace.hpp"
+#include "SwapDevice.hpp"
 #include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <set>
 #include <vector>
-#include <list>
 #include <string>
+#include <cstdint>
+#include <ostream>
+
+// Cycle costs charged to the virtual clock
+// (each cache level has its own latency, see CacheLevelConfig)
+struct LatencyConfig{
+    unsigned long long dram = 100;
+    unsigned long long page_walk = 5;          // per page table level read after a TLB miss
+    unsigned long long page_fault = 100000;     // bring a page in from disk
+    unsigned long long page_writeback = 100000; // write a victim page out to disk
+};
+
+// Headline numbers of a run, as printed by display_stats
+struct SimulationSummary{
+    size_t total_memory = 0;
+    size_t used_memory = 0;
+    size_t free_memory = 0;
+    size_t largest_free_block = 0;
+    int free_block_count = 0;
+    double utilization = 0;      // virtual, percent
+    int occupied_frames = 0;
+    size_t total_frames = 0;
+    double phys_utilization = 0; // percent
+    double fragmentation = 0;    // external, percent
+    size_t internal_fragmentation = 0;
+    size_t malloc_requests = 0;
+    size_t successful_mallocs = 0;
+    double success_rate = 0;     // percent of mallocs
+    size_t page_faults = 0;
+    size_t page_evictions = 0;
+    size_t page_writebacks = 0;
+    unsigned long long simulated_cycles = 0;
+    size_t memory_accesses = 0;
+    double amat = 0;             // cycles
+    size_t page_walks = 0;
+    double avg_walk_depth = 0;
+    long long tlb_hits = 0;
+    long long tlb_misses = 0;
+    double tlb_hit_ratio = 0;
+    std::vector<long long> cache_hits;   // one per level, L1 first
+    std::vector<long long> cache_misses;
+    std::vector<double> cache_hit_ratios;
+    size_t dram_bytes = 0;       // read and written
+    std::vector<size_t> prefetches;        // per level, lines brought in by its prefetcher
+    std::vector<size_t> useful_prefetches; // of them, used by a demand access
+    std::vector<size_t> late_prefetches;   // used before they had arrived
+    size_t prefetch_dram_bytes = 0;        // read for prefetches, included in dram_bytes
+    size_t prefetch_unused_bytes = 0;      // of them, for prefetches never used
+    size_t prefetch_pollution_bytes = 0;   // demand reads of lines a prefetch had pushed out
+    size_t slab_count = 0;
+    size_t slab_bytes = 0;       // heap bytes held by slabs, included in used_memory
+    size_t slab_live_bytes = 0;  // handed out as objects, rounded to their size class
+    double slab_cache_hit_ratio = 0; // percent of slab mallocs served by the PID's own cache
+    double avg_allocate_ns = 0;  // wall-clock cost of a malloc, 0 without instrumentation
+    size_t compaction_bytes_moved = 0;
+    size_t compaction_pauses = 0;
+    unsigned long long max_compaction_pause = 0; // cycles
+    size_t address_spaces = 0;   // 1 in shared mode
+    size_t mapped_bytes = 0;     // in Mapping regions, included in used_memory
+    size_t swap_bytes_written = 0; // swap file I/O, 0 without a swap file
+    size_t swap_bytes_read = 0;
+    double swap_overlap = 0;     // percent of the write-back done while the simulation ran on
+    size_t swap_integrity_errors = 0; // pages read back from swap that did not match
+};
+
+// Work done by heap compaction
+struct CompactionStats{
+    size_t passes = 0;            // finished walks over the heap
+    size_t blocks_moved = 0;
+    size_t bytes_moved = 0;
+    size_t pauses = 0;            // steps that moved something (one per operation when incremental)
+    unsigned long long pause_cycles = 0; // all pauses, on the virtual clock
+    unsigned long long max_pause_cycles = 0;
+    size_t pages_remapped = 0;    // destination pages brought in for the moved data
+    size_t frames_released = 0;   // source pages the process no longer uses
+    size_t lines_invalidated = 0; // stale cache lines of moved data
+    double fragmentation_recovered = 0; // external fragmentation points, summed over passes
+};
+
+class StatsSampler;
 
 class MemoryManager{
     private:
         size_t total_size; //total physical memory simulated
-        MemoryBlock* head; //start of memory list
-        std::string current_strategy; // first fit, best fit or worst fit
+        BlockPool block_pool; // every node of every block list; must outlive the spaces
+        std::string current_strategy; // display name of strategy
+        AllocStrategy strategy = AllocStrategy::FirstFit;
+
+        //Virtual address spaces. Shared mode (the default) runs every PID in one space with
+        //a fixed 64 KB heap; private mode gives each process a growable space of its own
+        AddressSpace* shared_space;
+        bool private_spaces = false;
+        std::unordered_map<int, AddressSpace*> spaces; // owner PID -> space, private mode only
+        static const size_t SHARED_HEAP = 65536;
+        static const size_t PRIVATE_HEAP = 4096;      // first heap of a private space
+        static const size_t MMAP_THRESHOLD = 131072;  // larger mallocs get a Mapping (private mode)
+        int owner_of(int pid) const; // the PID whose address space pid runs in
+        AddressSpace* space_of(int pid, bool create = false); // nullptr if it has none
+        size_t address_top() const; // end of a private space: page table reach, at most 2^47
+        void delete_space(int owner);
+
+        //Totals over every space, brought up to date by recount after each change to a space,
+        //so summarize never visits the spaces
+        size_t heap_size_total = 0;
+        size_t heap_used_total = 0;
+        size_t mapped_total = 0;
+        size_t mapping_total = 0;
+        size_t free_block_total = 0;
+        size_t largest_free_total = 0;           // sum of the spaces' largest free blocks
+        std::multiset<size_t> largest_free_blocks; // one per space
+        void recount(AddressSpace* space);
+        void uncount(AddressSpace* space);
+        struct Recount; // recounts a space when the scope ends
+
+        //Small mallocs under Slab, one allocator per space. Its slabs are USED blocks of the
+        //list owned by SLAB_OWNER; it outlives strategy switches, so objects handed out
+        //earlier can still be freed
+        SlabStats slab_stats;
+        static const int SLAB_OWNER = -2;
+        MemoryBlock* take_block(AddressSpace* space, size_t size); // grows a private heap if needed
+        void release_owned(int pid, AddressSpace* space, MemoryBlock* block); // heap block or Mapping of pid
+
+        //Compaction slides allocated blocks down over the free gaps, lowest address first.
+        //A moved block keeps answering to the address allocate returned: relocations maps it
+        //to the block wherever it is now, for access_memory and deallocate
+        struct Relocations{
+            std::map<size_t, MemoryBlock*> by_address;           // address given to the process -> block
+            std::unordered_map<MemoryBlock*, size_t> address_of; // the reverse
+        };
+        std::unordered_map<int, Relocations> relocations;
+        CompactionStats compaction;
+        size_t compact_budget = 0;       // bytes moved per operation, 0: no incremental compaction
+        double compact_threshold = 50.0; // external fragmentation (percent) that starts a pass
+        size_t compact_step(AddressSpace* space, size_t budget); // moves blocks until budget bytes are moved or the pass ends
+        void move_block(AddressSpace* space, MemoryBlock* gap, MemoryBlock* block); // block slides down to gap's address
+        void fix_up_pages(int pid, size_t old_start, MemoryBlock* block);
+        void copy_bytes(PageTable* table, int frame, size_t from, size_t to, size_t distance); // swap only: the moved bytes
+        bool page_in_use(int pid, size_t page, MemoryBlock* near) const;
+        size_t release_page(int pid, PageTable* table, size_t page); // frees a resident page, returns cache lines dropped
+        void start_pass(AddressSpace* space);
+        void end_pass(AddressSpace* space);
+        size_t relocate(int pid, size_t address) const; // where a process's address is now
+        void forget_relocation(int pid, MemoryBlock* block);
+        void retire_relocations(int pid, size_t address, size_t size); // the range was handed out again
+        double external_fragmentation() const; // over every space
 
-        //Cache hierarchy
-        Cache* l1_cache;
-        Cache* l2_cache;
+        //Cache hierarchy, rebuilt from cache_levels whenever it is reconfigured
+        CacheHierarchy* caches;
+        std::vector<CacheLevelConfig> cache_levels;
+        CacheInclusion cache_inclusion = CacheInclusion::NonInclusive;
+
+        //Multi-core mode: private L1 per core, PIDs placed on cores by the scheduler (nullptr: one core)
+        Scheduler* scheduler = nullptr;
+        std::unordered_map<int, int> thread_owner; // thread id -> PID whose address space it runs in
+
+        //Translation cache in front of the page tables
+        TLB* tlb;
+
+        //Reuse distance profiling of every translated access (nullptr: off)
+        ReuseProfiler* profiler = nullptr;
+        void restart_profiler(); // for the current block and page sizes
 
         //Virtual Memory Constants
         size_t page_size = 256;
+        int page_table_levels = 4;
+        int page_table_bits = 9; // index bits per level
         size_t physical_memory_size; // The RAM size
         size_t total_frames;
+        void setup_frames(); // frame table and free bitmap for physical_memory_size / page_size
 
         // Virtual memory structures
 
@@ -32,7 +196,44 @@ class MemoryManager{
         //Global frame table (to track which process owns which frame)
         //-1 means free. >=0 means PID
         std::vector<int> frame_table;
-        std::list<int> active_frames_fifo; // Tracks allocated frames for FIFO eviction
+        std::vector<size_t> frame_page; // Reverse map: virtual page held by each frame
+        std::vector<char> pinned_frames; // frames of a block being moved, never picked as victims
+
+        //Free frames: one bit per frame (1 = free), searched from the lowest word that may have one
+        std::vector<uint64_t> free_frame_bitmap;
+        size_t free_frame_hint = 0;
+        size_t free_frame_count = 0;
+
+        //Swap file (off unless set_swap is given one). Frames then hold real bytes, and a page
+        //keeps its copy in swap until its process goes: an evicted page is written only if
+        //dirty, a clean one still matches its copy (or is all zeros if it never had one)
+        struct SwapCopy{
+            size_t slot;
+            uint64_t checksum; // of the page as written, checked when it is read back
+        };
+        SwapDevice* swap = nullptr;
+        std::vector<uint8_t> frame_data; // total_frames pages
+        std::unordered_map<int, std::unordered_map<size_t, SwapCopy>> swap_copies; // PID -> page -> copy
+        size_t swap_outs = 0;        // pages written to swap
+        size_t swap_ins = 0;         // pages read back
+        size_t clean_evictions = 0;  // evictions that needed no write
+        size_t integrity_errors = 0;
+        void page_out(int pid, size_t page, int frame, bool dirty);
+        void page_in(int pid, size_t page, int frame); // fills the frame: from swap, or zeros
+        bool has_swap_copy(int pid, size_t page) const;
+        void drop_swap_copy(int pid, size_t page);
+        void drop_swap_copies(int pid);
+        uint64_t page_checksum(int frame) const;
+
+        //Page replacement, chosen with set_page_policy (FIFO by default)
+        ReplacementPolicy* page_policy;
+        std::string page_policy_name;
+        std::vector<size_t> lookahead; // next-use indices for OPT, from a replayed trace
+
+        //Per-process index: owned blocks (by start address) and resident frames,
+        //so freeing a process only touches what it owns
+        std::unordered_map<int, std::map<size_t, MemoryBlock*>> process_blocks;
+        std::unordered_map<int, std::unordered_set<int>> process_frames;
 
         //Metrics
         size_t internal_fragmentation = 0;
@@ -40,6 +241,28 @@ class MemoryManager{
         size_t successful_allocs = 0;
         size_t failed_allocs = 0;
 
+        //Virtual clock: every access adds its simulated cost here
+        LatencyConfig latency;
+        unsigned long long simulated_cycles = 0;
+        size_t memory_accesses = 0;
+        size_t page_faults = 0;
+        size_t page_evictions = 0;
+        size_t page_writebacks = 0; // evictions of dirty pages
+        size_t page_walks = 0;
+        size_t page_walk_levels = 0; // page table nodes read by all walks
+        size_t segmentation_faults = 0;
+
+        //When false, nothing is printed per event
+        bool verbose = true;
+
+        //Wall-clock timing of the simulator's own hot paths
+        Instrumentation instrumentation;
+
+        //Time series of the stats, one row every few operations (nullptr: off, not owned)
+        StatsSampler* sampler = nullptr;
+        void note_operation(AddressSpace* space); // called by every malloc, free and access (space may be nullptr)
+        void dump_heap(const AddressSpace* space) const;
+
     public:
         MemoryManager(size_t size); //declaration of constructor. Initialize memory
         ~MemoryManager(); //Cleanup memory to prevent memory leaks!
@@ -47,15 +270,50 @@ class MemoryManager{
         //Core functions
         long long allocate(size_t size, int process_id);
         void deallocate(int process_id);
-        void access_memory(size_t virtual_addr, int pid);
+        void deallocate(int process_id, size_t address); // frees one block returned by allocate
+        void access_memory(size_t virtual_addr, int pid, bool write = false);
+        int peek(size_t virtual_addr, int pid); // a read access, returning the byte read; -1 without swap or if it failed
 
         //Helpers   
-        int get_free_frame_or_evict(int pid);
-        size_t virtual_to_physical(int pid, size_t virtual_addr);
+        int get_free_frame_or_evict(int pid, size_t now); // now: access index for the replacement policy; -1 if RAM has no frame
+        int take_free_frame(); // lowest free frame, or -1
+        void return_free_frame(int frame);
+        bool test_and_clear_referenced(int frame);
+        size_t virtual_to_physical(int pid, size_t virtual_addr, bool write = false); // INVALID_ADDRESS if unmappable
+        static const size_t INVALID_ADDRESS = (size_t)-1;
 
         // ... stats, strategy setter, etc ... 
         void set_strategy(std::string strategy);
+        bool set_private_spaces(bool enabled); // only before the first malloc or access
+        bool has_private_spaces() const { return private_spaces; }
+        void set_verbose(bool enabled);
+        void set_latency(const LatencyConfig& config);
+        bool set_page_policy(const std::string& name, size_t ws_window = 1000); // false if unknown
+        void set_lookahead(std::vector<size_t> next_use);
+        size_t get_page_size() const { return page_size; }
+        size_t get_ram_size() const { return physical_memory_size; }
+        bool set_page_size(size_t bytes); // power of two, only before the first access
+        bool set_swap(const std::string& path); // swap file, "" for none; only before the first access
+        bool configure_tlb(size_t entries, size_t assoc, const std::string& policy, bool asid); // false, keeping the TLB, if invalid
+        const TLB& get_tlb() const { return *tlb; }
+        bool set_cache_policy(int level, const std::string& policy); // level from 1, empties the caches
+        bool configure_caches(const std::vector<CacheLevelConfig>& levels, CacheInclusion inclusion); // empties the caches
+        bool set_cores(size_t cores, const std::string& policy = "affinity", size_t quantum = 1000); // empties the caches
+        bool add_thread(int tid, int pid); // tid's accesses use pid's address space but are scheduled on their own
+        bool configure_page_table(int levels, int bits_per_level); // only before the first access
+        void set_profiling(bool enabled); // (re)starts an empty profile
+        bool is_profiling() const { return profiler != nullptr; }
+        void display_profile();
+        bool write_profile(const std::string& path) const; // false if off or the file cannot be opened
+        bool compact(); // one full pass now; false under Buddy
+        void set_compaction(size_t budget, double threshold = 50.0); // incremental, budget 0 turns it off
+        const CompactionStats& get_compaction_stats() const { return compaction; }
+        SimulationSummary summarize() const; // O(cache levels): every figure is kept up to date
+        void set_sampler(StatsSampler* stats_sampler); // nullptr stops sampling
+        void write_sample(); // one row now, e.g. the final state
+        void flush_swap(); // waits until every page written to swap is in the file; reports call it first
         void display_stats();
+        void write_json(std::ostream& out); // the simulated metrics and the internal timings
         size_t next_power_of_two(size_t n);
         void dump_memory();
 };
@@ -1,32 +1,63 @@
 #ifndef PAGE_TABLE_HPP
 #define PAGE_TABLE_HPP
 
-#include <unordered_map>
 #include <iostream>
 #include <vector>
 
 struct PageTableEntry{
     int frame_number;
     bool valid; // true if the page is in physical memory
+    bool referenced; // set by every page walk that finds the page, cleared by the replacement policy
+    bool dirty; // set by writes; only dirty pages are written back when evicted
 };
 
+// Multi-level radix page table. A page number is split into `levels` indices of
+// `bits_per_level` bits each, most significant first. Interior nodes hold child
+// pointers, leaf nodes hold the PageTableEntries, and nodes are created on demand.
 class PageTable{
 private:
-    //Maps Page Number -> PageTableEntry
-    std::unordered_map<int, PageTableEntry> entries;
+    struct Node{
+        Node** children = nullptr;            // interior levels
+        PageTableEntry* entries = nullptr;    // last level
+    };
+
     size_t page_size;
+    int levels;
+    int bits_per_level;
+    size_t fanout; // 1 << bits_per_level
+    Node root;
+
+    int last_depth = 0; // nodes read by the most recent walk
+
+    size_t index_at(size_t page_num, int level) const;
+    void destroy(Node& node, int level);
 
 public:
-    PageTable(size_t pg_size);
+    static const int MAX_BITS_PER_LEVEL = 16; // 64K-entry nodes
+
+    //Geometry with levels * bits > 64 or bits > MAX_BITS_PER_LEVEL falls back to 4 x 9
+    PageTable(size_t pg_size, int num_levels = 4, int bits = 9);
+    ~PageTable();
+    PageTable(const PageTable&) = delete;
+    PageTable& operator=(const PageTable&) = delete;
+
+    //True if the page number fits in levels * bits_per_level bits
+    bool covers(size_t page_num) const;
 
     //Maps a virtual page to a physical frame
-    void map(int page_num, int frame_num);
+    void map(size_t page_num, int frame_num);
 
     //Return frame number, or -1 if Page Fault
-    int translate(int page_num);
+    int translate(size_t page_num);
+
+    //Entry of a mapped page, or nullptr if its leaf was never created
+    PageTableEntry* lookup(size_t page_num);
+
+    //Marks one page as no longer in RAM (its frame was evicted)
+    void invalidate(size_t page_num);
 
-    //Finds which page points to a specific frame and invalidates it
-    void invalidate_frame(int frame_num);
+    int get_last_depth() const { return last_depth; }
+    int get_levels() const { return levels; }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,38 @@
+#ifndef PREFETCHER_HPP
+#define PREFETCHER_HPP
+
+#include <string>
+#include <vector>
+
+// Prefetcher of one cache level. It sees the demand accesses that reach its level
+// (line numbers, i.e. address / block size) and names lines to bring in ahead of use.
+// The hierarchy drops candidates already present, so a model need not track contents.
+//  - degree: lines named per trigger
+//  - distance: how far ahead of the triggering line the first of them is (counted in
+//    strides by the stride model); the stream model never runs further ahead than that
+class Prefetcher{
+public:
+    virtual ~Prefetcher() = default;
+
+    virtual const char* name() const = 0;
+
+    // miss: the line was not in the level. prefetch_hit: it was, brought in by a prefetch
+    // and used for the first time. Candidates are appended to out.
+    virtual void observe(size_t line, bool miss, bool prefetch_hit, std::vector<size_t>& out) = 0;
+
+    size_t get_degree() const { return degree; }
+    size_t get_distance() const { return distance; }
+
+protected:
+    size_t degree = 1;
+    size_t distance = 1;
+};
+
+// name: "next_line", "stride" or "stream". Returns nullptr if unknown.
+// A degree or distance of 0 takes the model's default.
+Prefetcher* make_prefetcher(const std::string& name, size_t degree = 0, size_t distance = 0);
+
+// "<name>[/degree[/distance]]", e.g. "stream/4/16"
+bool parse_prefetcher(const std::string& spec, std::string& name, size_t& degree, size_t& distance);
+
+#endif
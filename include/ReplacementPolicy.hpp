@@ -0,0 +1,39 @@
+#ifndef REPLACEMENT_POLICY_HPP
+#define REPLACEMENT_POLICY_HPP
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Chooses which resident frame to evict when physical memory is full.
+// `now` is the index of the current memory access (the virtual time).
+// pick_victim() is only called while every frame is resident; the chosen
+// frame stays tracked and is reported again through on_load() once refilled,
+// or through on_skip() if it was pinned and could not be evicted.
+class ReplacementPolicy{
+public:
+    virtual ~ReplacementPolicy() = default;
+
+    virtual const char* name() const = 0;
+
+    virtual void on_load(int frame, size_t now) = 0; // frame now holds a new page
+    virtual void on_access(int, size_t) {}           // resident page referenced again
+    virtual void on_release(int frame) = 0;          // frame freed by its process
+    virtual int pick_victim(size_t now) = 0;
+    virtual void on_skip(int frame, size_t now) { on_load(frame, now); } // picked but kept resident
+
+    //Only OPT uses it: next_use[i] is the access index at which the page of
+    //access i is used again (SIZE_MAX if never)
+    virtual void set_lookahead(const std::vector<size_t>*) {}
+};
+
+// Reads and clears the referenced bit of the page held by a frame
+typedef std::function<bool(int frame)> ReferenceBitFn;
+
+// name: "fifo", "lru", "clock", "second_chance", "ws" or "opt". Returns nullptr if unknown.
+// ws_window is the working-set window (in accesses) of the "ws" policy.
+ReplacementPolicy* make_replacement_policy(const std::string& name, size_t frames,
+                                           ReferenceBitFn test_and_clear_referenced,
+                                           size_t ws_window = 1000);
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef REUSE_PROFILER_HPP
+#define REUSE_PROFILER_HPP
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// LRU stack distances of one stream of keys, in one pass.
+// The distance of an access is the number of distinct other keys used since the
+// previous access to the same key, so a fully associative LRU store of C entries
+// hits exactly the accesses with distance < C. A Fenwick tree over time stamps
+// holds a 1 at the latest access of every key; the distance is the sum between
+// the key's previous stamp and now, in O(log n).
+class ReuseDistance{
+private:
+    std::vector<uint32_t> tree; // Fenwick tree, 1-based, over stamps 0 .. capacity-1
+    std::unordered_map<uint64_t, size_t> last_use; // key -> stamp of its latest access
+    size_t now = 0; // next stamp
+
+    std::vector<size_t> histogram; // [d]: accesses at distance d
+    size_t cold = 0;  // first accesses (infinite distance)
+    size_t total = 0;
+
+    void add(size_t stamp, int delta);
+    size_t prefix(size_t end) const; // live stamps < end
+    void compact(); // renumbers the live stamps 0 .. n-1 once the tree is full
+
+public:
+    static const size_t COLD = (size_t)-1;
+
+    ReuseDistance();
+    size_t access(uint64_t key); // distance, or COLD
+
+    size_t get_total() const { return total; }
+    size_t get_cold() const { return cold; }
+    size_t distinct() const { return last_use.size(); }
+    const std::vector<size_t>& get_histogram() const { return histogram; }
+
+    //curve[c] = miss ratio of a fully associative LRU store of c entries,
+    //for c = 0 .. distinct(); larger stores only take cold misses
+    std::vector<double> miss_ratio_curve() const;
+    double miss_ratio(size_t capacity) const;
+};
+
+// Miss-ratio curves of the physical addresses a MemoryManager sends to its caches:
+// one per cache block size, plus one per page (keyed by PID and virtual page, since
+// the frame a page lands in depends on the RAM size being studied).
+class ReuseProfiler{
+private:
+    struct Curve{
+        std::string name; // "16B blocks", "256B pages"
+        size_t unit;      // bytes per entry
+        ReuseDistance distances;
+    };
+
+    struct PageHash{
+        size_t operator()(const std::pair<int, size_t>& key) const {
+            return std::hash<size_t>()(key.second * 0x9E3779B97F4A7C15ULL ^ (size_t)key.first);
+        }
+    };
+
+    std::vector<Curve> curves; // block sizes ascending, then the page curve
+    std::unordered_map<std::pair<int, size_t>, uint64_t, PageHash> page_ids; // (pid, page) -> key
+
+public:
+    ReuseProfiler(std::vector<size_t> block_sizes, size_t page_size);
+
+    void record(size_t physical_addr, int pid, size_t virtual_page);
+
+    size_t curve_count() const { return curves.size(); }
+    size_t page_curve() const { return curves.size() - 1; }
+    size_t curve_of_block(size_t block_size) const; // index of that block size's curve
+    const std::string& curve_name(size_t curve) const { return curves[curve].name; }
+    size_t unit(size_t curve) const { return curves[curve].unit; }
+    const ReuseDistance& distances(size_t curve) const { return curves[curve].distances; }
+
+    //Every curve at power-of-two capacities
+    void display();
+    //Every point where a curve changes (it is a step function), as
+    //curve,unit_bytes,entries,bytes,miss_ratio. False if the file cannot be opened.
+    bool write_csv(const std::string& path) const;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <unordered_map>
+#include <vector>
+#include <string>
+
+// Places the accesses of each PID on a simulated core.
+//  - "affinity": a PID stays on the core it was first placed on (the one running the fewest PIDs).
+//  - "rr": every `quantum` accesses the PIDs rotate one core further, as if time slices
+//    were handed out round robin, so they migrate and drag their lines between L1s.
+class Scheduler{
+private:
+    struct Placement{
+        size_t home; // core chosen on first access
+        size_t last; // core of the previous access
+    };
+
+    size_t cores;
+    bool round_robin;
+    size_t quantum;
+    std::unordered_map<int, Placement> placements;
+    std::vector<size_t> load; // PIDs homed on each core
+    size_t ticks = 0;
+    size_t migrations = 0;
+
+public:
+    Scheduler(size_t core_count, const std::string& policy = "affinity", size_t slice = 1000);
+
+    static bool is_policy(const std::string& policy);
+
+    size_t core_for(int pid); // called once per access
+    void release(int pid);    // the process is gone
+
+    size_t get_cores() const { return cores; }
+    void display_stats();
+};
+
+#endif
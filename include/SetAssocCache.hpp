@@ -0,0 +1,328 @@
+#ifndef SET_ASSOC_CACHE_HPP
+#define SET_ASSOC_CACHE_HPP
+
+#include "Cache.hpp"
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Geometry known only at run time. Power-of-two shapes index with shifts and masks.
+struct DynamicGeometry{
+    size_t size, block_size, assoc, num_sets;
+    bool pow2;
+    unsigned block_shift, set_shift;
+
+    DynamicGeometry(size_t sz, size_t block_sz, size_t associativity)
+        : size(sz), block_size(block_sz), assoc(associativity) {
+        if (block_size == 0 || assoc == 0) {
+            std::cerr << "Error: Invalid Cache Configuration (Block Size or Assoc is 0)\n";
+            if (block_size == 0) block_size = 1; // Fallback to avoid crash
+            if (assoc == 0) assoc = 1;
+        }
+        num_sets = size / (block_size * assoc);
+        if (num_sets == 0) num_sets = 1;
+
+        pow2 = (block_size & (block_size - 1)) == 0 && (num_sets & (num_sets - 1)) == 0;
+        block_shift = 0;
+        while (((size_t)1 << block_shift) < block_size) block_shift++;
+        set_shift = 0;
+        while (((size_t)1 << set_shift) < num_sets) set_shift++;
+    }
+
+    size_t block_of(size_t address) const { return pow2 ? address >> block_shift : address / block_size; }
+    size_t set_of(size_t block_addr) const { return pow2 ? block_addr & (num_sets - 1) : block_addr % num_sets; }
+    size_t tag_of(size_t block_addr) const { return pow2 ? block_addr >> set_shift : block_addr / num_sets; }
+    size_t address_of(size_t tag, size_t set) const { return (tag * num_sets + set) * block_size; }
+};
+
+// Geometry fixed at compile time: every index computation and way loop folds to constants
+template<size_t SIZE, size_t BLOCK, size_t ASSOC>
+struct StaticGeometry{
+    static_assert(BLOCK > 0 && ASSOC > 0 && SIZE >= BLOCK * ASSOC, "invalid cache geometry");
+    static constexpr size_t size = SIZE;
+    static constexpr size_t block_size = BLOCK;
+    static constexpr size_t assoc = ASSOC;
+    static constexpr size_t num_sets = SIZE / (BLOCK * ASSOC);
+
+    static size_t block_of(size_t address) { return address / BLOCK; }
+    static size_t set_of(size_t block_addr) { return block_addr % num_sets; }
+    static size_t tag_of(size_t block_addr) { return block_addr / num_sets; }
+    static size_t address_of(size_t tag, size_t set) { return (tag * num_sets + set) * BLOCK; }
+};
+
+// Index of the way holding key in ways[0..assoc), or -1. Compares two ways per SSE2 instruction.
+inline int find_way(const uint64_t* ways, size_t assoc, uint64_t key){
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i wanted = _mm_set1_epi64x((long long)key);
+    for (; i + 2 <= assoc; i += 2) {
+        __m128i pair = _mm_loadu_si128((const __m128i*)(ways + i));
+        // SSE2 has no 64-bit compare: a way matches when both of its 32-bit halves do
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(pair, wanted)));
+        if ((mask & 0x3) == 0x3) return (int)i;
+        if ((mask & 0xC) == 0xC) return (int)i + 1;
+    }
+#endif
+    for (; i < assoc; i++) {
+        if (ways[i] == key) return (int)i;
+    }
+    return -1;
+}
+
+// Set-associative cache over any geometry.
+// Tags of all lines live in one array, set by set, stored as tag + 1 so that 0 means invalid.
+template<class Geometry>
+class SetAssocCache : public Cache{
+private:
+    static constexpr uint8_t RRPV_MAX = 3;  // 2-bit counters
+    static constexpr uint8_t RRPV_LONG = 2; // SRRIP insertion: "re-referenced in a long interval"
+
+    Geometry geo;
+    CachePolicy policy;
+
+    std::vector<uint64_t> tags;      // num_sets * assoc, 0 = invalid
+    std::vector<uint8_t> flags;      // per line, parallel to tags: LINE_DIRTY (Modified), LINE_SHARED, LINE_PREFETCHED
+    static constexpr uint8_t LINE_DIRTY = 1;
+    static constexpr uint8_t LINE_SHARED = 2;
+    static constexpr uint8_t LINE_PREFETCHED = 4; // filled by a prefetch, not used by a demand access yet
+
+    // Replacement state, in flat arrays indexed by set (or set * assoc + way)
+    std::vector<uint32_t> fifo_next; // FIFO: next way to replace in each set
+    std::vector<uint16_t> age;       // LRU: rank of each line, 0 = most recently used
+    std::vector<uint64_t> plru_bits; // Tree-PLRU: one bit per tree node, per set
+    std::vector<uint8_t> rrpv;       // SRRIP/BRRIP: re-reference prediction per line
+    unsigned rng_state = 2463534242u; // BRRIP's occasional long insertion
+
+    //Stats
+    long long hits = 0;
+    long long misses = 0;
+
+    // Position of the line holding address: set index, and way or -1
+    int locate(size_t address, size_t& set_index, uint64_t& key) const{
+        size_t block_addr = geo.block_of(address);
+        set_index = geo.set_of(block_addr);
+        key = (uint64_t)geo.tag_of(block_addr) + 1;
+        return find_way(&tags[set_index * geo.assoc], geo.assoc, key);
+    }
+
+    // Sets the MESI bits of a line; its prefetch mark stays until a demand access claims it
+    void set_flags(size_t line, uint8_t state_bits){
+        flags[line] = (uint8_t)(state_bits | (flags[line] & LINE_PREFETCHED));
+    }
+
+    void lru_promote(size_t set_index, size_t way){
+        uint16_t* ranks = &age[set_index * geo.assoc];
+        uint16_t old_rank = ranks[way];
+        for (size_t i = 0; i < geo.assoc; i++) {
+            if (ranks[i] < old_rank) ranks[i]++;
+        }
+        ranks[way] = 0;
+    }
+
+    // Tree nodes are numbered 1..assoc-1 in heap order; a bit of 1 sends the victim
+    // search to the right child. Touching a way points every node on its path away from it.
+    void plru_touch(size_t set_index, size_t way){
+        uint64_t& bits = plru_bits[set_index];
+        size_t node = way + geo.assoc;
+        while (node > 1) {
+            size_t parent = node / 2;
+            if (node % 2 == 0) bits |= ((uint64_t)1 << parent);  // touched left, point right
+            else bits &= ~((uint64_t)1 << parent);              // touched right, point left
+            node = parent;
+        }
+    }
+
+    void on_hit(size_t set_index, size_t way){
+        switch (policy) {
+            case CachePolicy::LRU: lru_promote(set_index, way); break;
+            case CachePolicy::PLRU: plru_touch(set_index, way); break;
+            case CachePolicy::SRRIP:
+            case CachePolicy::BRRIP: rrpv[set_index * geo.assoc + way] = 0; break;
+            case CachePolicy::FIFO: break;
+        }
+    }
+
+    void on_fill(size_t set_index, size_t way){
+        switch (policy) {
+            case CachePolicy::LRU: lru_promote(set_index, way); break;
+            case CachePolicy::PLRU: plru_touch(set_index, way); break;
+            case CachePolicy::SRRIP: rrpv[set_index * geo.assoc + way] = RRPV_LONG; break;
+            case CachePolicy::BRRIP:
+                // Mostly "distant" insertion, "long" only once every 32 fills
+                rng_state ^= rng_state << 13;
+                rng_state ^= rng_state >> 17;
+                rng_state ^= rng_state << 5;
+                rrpv[set_index * geo.assoc + way] = (rng_state % 32 == 0) ? RRPV_LONG : RRPV_MAX;
+                break;
+            case CachePolicy::FIFO: break;
+        }
+    }
+
+    size_t pick_victim(size_t set_index){
+        //An empty way is always used first
+        int empty = find_way(&tags[set_index * geo.assoc], geo.assoc, 0);
+        if (empty >= 0) return (size_t)empty;
+
+        switch (policy) {
+            case CachePolicy::LRU: {
+                const uint16_t* ranks = &age[set_index * geo.assoc];
+                return std::max_element(ranks, ranks + geo.assoc) - ranks;
+            }
+            case CachePolicy::PLRU: {
+                uint64_t bits = plru_bits[set_index];
+                size_t node = 1;
+                while (node < geo.assoc) node = 2 * node + ((bits >> node) & 1);
+                return node - geo.assoc;
+            }
+            case CachePolicy::SRRIP:
+            case CachePolicy::BRRIP: {
+                uint8_t* values = &rrpv[set_index * geo.assoc];
+                while (true) {
+                    for (size_t i = 0; i < geo.assoc; i++) {
+                        if (values[i] == RRPV_MAX) return i;
+                    }
+                    for (size_t i = 0; i < geo.assoc; i++) values[i]++;
+                }
+            }
+            case CachePolicy::FIFO:
+            default: {
+                //Set is full -> evict the oldest fill, round robin
+                size_t way = fifo_next[set_index];
+                fifo_next[set_index] = (uint32_t)((way + 1) % geo.assoc);
+                return way;
+            }
+        }
+    }
+
+public:
+    SetAssocCache(const Geometry& geometry, CachePolicy replacement) : geo(geometry), policy(replacement) {
+        // The PLRU tree needs a power-of-two number of ways that fits in one word
+        if (policy == CachePolicy::PLRU && (geo.assoc > 64 || (geo.assoc & (geo.assoc - 1)) != 0)) {
+            std::cerr << "Error: Tree-PLRU needs a power-of-two associativity <= 64, using LRU\n";
+            policy = CachePolicy::LRU;
+        }
+
+        size_t lines = geo.num_sets * geo.assoc;
+        tags.assign(lines, 0);
+        flags.assign(lines, 0);
+        fifo_next.assign(geo.num_sets, 0);
+        age.resize(lines);
+        for (size_t i = 0; i < lines; i++) age[i] = (uint16_t)(i % geo.assoc);
+        plru_bits.assign(geo.num_sets, 0);
+        rrpv.assign(lines, RRPV_MAX);
+    }
+
+    bool lookup(size_t address, bool mark_dirty) override{
+        size_t set_index;
+        uint64_t key;
+        int way = locate(address, set_index, key);
+        if (way < 0) {
+            misses++;
+            return false;
+        }
+        hits++;
+        on_hit(set_index, (size_t)way);
+        if (mark_dirty) set_flags(set_index * geo.assoc + way, LINE_DIRTY);
+        return true;
+    }
+
+    CacheVictim fill(size_t address, bool is_dirty, bool prefetched = false) override{
+        size_t block_addr = geo.block_of(address);
+        size_t set_index = geo.set_of(block_addr);
+        size_t way = pick_victim(set_index);
+        size_t line = set_index * geo.assoc + way;
+
+        CacheVictim victim{tags[line] != 0, 0, (flags[line] & LINE_DIRTY) != 0, (flags[line] & LINE_PREFETCHED) != 0};
+        if (victim.valid) victim.address = geo.address_of((size_t)(tags[line] - 1), set_index);
+
+        //Update the hardware line
+        tags[line] = (uint64_t)geo.tag_of(block_addr) + 1;
+        flags[line] = (uint8_t)((is_dirty ? LINE_DIRTY : 0) | (prefetched ? LINE_PREFETCHED : 0));
+        on_fill(set_index, way);
+        return victim;
+    }
+
+    bool contains(size_t address) const override{
+        size_t set_index;
+        uint64_t key;
+        return locate(address, set_index, key) >= 0;
+    }
+
+    bool set_dirty(size_t address) override{
+        size_t set_index;
+        uint64_t key;
+        int way = locate(address, set_index, key);
+        if (way < 0) return false;
+        set_flags(set_index * geo.assoc + way, LINE_DIRTY);
+        return true;
+    }
+
+    bool claim_prefetched(size_t address) override{
+        size_t set_index;
+        uint64_t key;
+        int way = locate(address, set_index, key);
+        if (way < 0) return false;
+        uint8_t& line_flags = flags[set_index * geo.assoc + way];
+        if (!(line_flags & LINE_PREFETCHED)) return false;
+        line_flags &= (uint8_t)~LINE_PREFETCHED;
+        return true;
+    }
+
+    bool invalidate(size_t address, bool& was_dirty) override{
+        size_t set_index;
+        uint64_t key;
+        int way = locate(address, set_index, key);
+        if (way < 0) return false;
+        size_t line = set_index * geo.assoc + way;
+        was_dirty = (flags[line] & LINE_DIRTY) != 0;
+        tags[line] = 0;
+        flags[line] = 0;
+        return true;
+    }
+
+    LineState state_of(size_t address) const override{
+        size_t set_index;
+        uint64_t key;
+        int way = locate(address, set_index, key);
+        if (way < 0) return LineState::Invalid;
+        uint8_t line_flags = flags[set_index * geo.assoc + way];
+        if (line_flags & LINE_DIRTY) return LineState::Modified;
+        return (line_flags & LINE_SHARED) ? LineState::Shared : LineState::Exclusive;
+    }
+
+    bool set_state(size_t address, LineState state) override{
+        if (state == LineState::Invalid) {
+            bool was_dirty;
+            return invalidate(address, was_dirty);
+        }
+        size_t set_index;
+        uint64_t key;
+        int way = locate(address, set_index, key);
+        if (way < 0) return false;
+        set_flags(set_index * geo.assoc + way, (state == LineState::Modified) ? LINE_DIRTY
+                                             : (state == LineState::Shared) ? LINE_SHARED : 0);
+        return true;
+    }
+
+    void display_stats() override{
+        long long total = hits + misses;
+        double ratio = (total == 0) ? 0.0 : (double)hits / total * 100.0;
+        std::cout << "Size: " << geo.size << "B | Assoc: " << geo.assoc
+                  << "-way | " << get_policy_name() << " | Hits: " << hits << " | Misses: " << misses
+                  << " | Hit Ratio: " << std::fixed << std::setprecision(2) << ratio << "%\n";
+    }
+
+    size_t get_size() const override { return geo.size; }
+    size_t get_block_size() const override { return geo.block_size; }
+    size_t get_associativity() const override { return geo.assoc; }
+    const char* get_policy_name() const override { return policy_name(policy); }
+    long long get_hits() const override { return hits; }
+    long long get_misses() const override { return misses; }
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef SHARDED_MEMORY_MANAGER_HPP
+#define SHARDED_MEMORY_MANAGER_HPP
+
+#include "MemoryManager.hpp"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+// Thread-safe front end for concurrent workload drivers. PIDs are partitioned over
+// shards (owner PID mod shard count) and every shard is a whole MemoryManager with
+// its own slice of the RAM: its own frame pool, page tables, address spaces, TLB and
+// caches, behind its own lock. Threads registered with add_thread run in the shard of
+// their process, so a call only ever takes one shard lock.
+//
+// A shard's caches see exactly the accesses of its PIDs, in the order they reach the
+// shard, so hit/miss results are deterministic whenever each shard is driven by one
+// stream (e.g. one client per PID group). Streams that share a shard interleave there
+// as the threads happen to run. In shared mode each shard has its own 64 KB heap.
+class ShardedMemoryManager{
+private:
+    struct Shard{
+        std::mutex lock;
+        MemoryManager* sim;
+        size_t acquisitions = 0; // driver calls, under lock
+        size_t contended = 0;    // of them, those that had to wait
+    };
+    std::vector<Shard*> shards;
+
+    //Thread id -> PID it runs in. Read by every call once a thread is registered
+    mutable std::shared_mutex routing_lock;
+    std::unordered_map<int, int> thread_owner;
+    std::atomic<bool> has_threads{false};
+
+    Shard& acquire(size_t index, bool counted = true) const; // locks the shard; counted: a driver call, for the contention figures
+    int thread_shard(int tid, int pid) const; // where tid may run for pid, -1 if not; routing_lock held
+
+public:
+    ShardedMemoryManager(size_t size, size_t shard_count); // size / shard_count bytes of RAM each
+    ~ShardedMemoryManager();
+    ShardedMemoryManager(const ShardedMemoryManager&) = delete;
+    ShardedMemoryManager& operator=(const ShardedMemoryManager&) = delete;
+
+    size_t shard_count() const { return shards.size(); }
+    size_t shard_of(int pid) const; // the shard pid's calls go to
+
+    //Core functions, as MemoryManager's; each locks the shard of pid only
+    long long allocate(size_t size, int process_id);
+    void deallocate(int process_id);
+    void deallocate(int process_id, size_t address);
+    void access_memory(size_t virtual_addr, int pid, bool write = false);
+    //False as MemoryManager::add_thread, or if tid already runs in another shard
+    bool add_thread(int tid, int pid);
+    //Records that tid runs in pid's shard without telling the shard; the caller then runs
+    //add_thread on it in order. Returns the shard, or -1 where add_thread would fail
+    int route_thread(int tid, int pid);
+
+    //Runs work on one shard under a single acquisition of its lock (batches of operations)
+    void run_on(size_t shard, const std::function<void(MemoryManager&)>& work);
+    //Runs setup on every shard in turn (strategy, caches, page policy, ...), or on one.
+    //Unlike the calls above these are not counted as lock acquisitions
+    void configure(const std::function<void(MemoryManager&)>& setup);
+    void configure_shard(size_t shard, const std::function<void(MemoryManager&)>& setup);
+
+    //Figures of all shards combined: counts add up and ratios are recomputed from them.
+    //Each shard is read under its lock, so with drivers running this is not one instant
+    SimulationSummary summarize() const;
+    void display_stats();
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef SLAB_ALLOCATOR_HPP
+#define SLAB_ALLOCATOR_HPP
+
+#include "MemoryBlock.hpp"
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+// Span of the virtual heap taken from / handed back to the block list
+typedef std::function<MemoryBlock*(size_t size)> TakeSpanFn;
+typedef std::function<void(MemoryBlock* span)> ReturnSpanFn;
+
+// Figures of every SlabAllocator that shares them (one allocator per address space)
+struct SlabStats{
+    size_t slabs = 0;
+    size_t slab_bytes = 0;
+    size_t live_objects = 0;
+    size_t live_bytes = 0;     // rounded sizes
+    size_t cached_objects = 0; // in the PID caches
+    size_t cache_hits = 0;     // allocations served straight from the PID's cache
+    size_t allocations = 0;
+
+    double cache_hit_ratio() const; // percent
+    void display() const;
+};
+
+// Size-class allocator in the style of tcmalloc / jemalloc for the "Slab" strategy.
+// Small requests are rounded up to a size class. Each class has slabs: spans of the
+// virtual heap cut into equal objects. Allocation goes through three tiers:
+//  1. the PID's own cache of free objects of that class (no shared state touched);
+//  2. the central pool, which refills the cache in batches from slabs with free objects;
+//  3. a new slab, carved from the block list through take_span.
+// Frees go back to the PID's cache; an overfull cache returns half to the central pool,
+// and a slab whose objects are all back in the pool is handed back through return_span.
+// Batches start at one object and double per refill, so a PID that allocates a class
+// once does not pin a batch of it.
+class SlabAllocator{
+public:
+    static const size_t MAX_SMALL = 512; // larger requests use the block list
+    static const size_t CLASS_COUNT = 16;
+    static const size_t CACHE_LIMIT = 16; // objects per PID and class before half are returned
+    static const size_t BATCH = 8;        // most objects moved per refill
+
+private:
+    struct Slab{
+        MemoryBlock* span;
+        size_t size_class;
+        size_t capacity;                // objects in the span
+        std::vector<size_t> free_objects; // addresses, lowest last
+        size_t partial_index;           // position in partial[size_class], or NOT_PARTIAL
+    };
+    static const size_t NOT_PARTIAL = (size_t)-1;
+
+    struct Cache{
+        std::vector<size_t> objects; // free, the next one to hand out last
+        size_t batch = 1;            // objects moved by the next refill
+    };
+
+    TakeSpanFn take_span;
+    ReturnSpanFn return_span;
+
+    std::map<size_t, Slab*> slabs;                       // by span start address
+    std::vector<std::vector<Slab*>> partial;             // central pool: slabs with free objects, per class
+    std::unordered_map<int, std::vector<Cache>> caches;                // PID -> one cache per class
+    std::unordered_map<int, std::unordered_map<size_t, size_t>> owned; // PID -> live object -> class
+
+    SlabStats& stats;
+    size_t cached_objects = 0; // in this allocator's caches
+
+    Slab* slab_of(size_t address) const;
+    void add_partial(Slab* slab);
+    void remove_partial(Slab* slab);
+    bool grow(size_t size_class);                     // new slab into the central pool
+    bool refill(Cache& cache, size_t size_class);
+    void release_object(size_t address);              // back into its slab (central pool)
+    size_t drain_caches(const Cache* keep);           // scavenge, leaving keep (may be nullptr) alone
+
+public:
+    SlabAllocator(TakeSpanFn take, ReturnSpanFn give_back, SlabStats& totals);
+    ~SlabAllocator(); // takes what is left out of the totals; the spans stay with the block list
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+    static bool is_small(size_t size) { return size <= MAX_SMALL; }
+    static size_t class_of(size_t size);      // index of the smallest class that holds size
+    static size_t class_size(size_t index);   // bytes per object of a class
+    static size_t span_size(size_t index);    // bytes per slab of a class (at least 8 objects)
+
+    long long allocate(int pid, size_t size); // -1 if no slab can be carved
+    size_t free(int pid, size_t address);     // size class of the freed object, 0 if pid owns none there
+    size_t free_process(int pid);             // frees every object of pid, returns how many
+    size_t scavenge();                        // empties every PID cache, returns the slab bytes given back
+};
+
+#endif
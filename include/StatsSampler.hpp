@@ -0,0 +1,41 @@
+#ifndef STATS_SAMPLER_HPP
+#define STATS_SAMPLER_HPP
+
+#include "MemoryManager.hpp"
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Time series of a run: one CSV row every `interval` operations (malloc, free or access).
+// Memory figures are the state at the row; the fault rate and hit ratios cover only
+// the accesses since the previous row, so phase changes show up instead of being
+// averaged away. It outlives the MemoryManagers it is attached to, so a trace with
+// several inits stays one series.
+class StatsSampler{
+private:
+    std::ofstream out;
+    size_t interval = 1;
+    size_t operations = 0;
+    bool header_written = false;
+    size_t last_row = (size_t)-1; // operation count of the latest row
+
+    //Counters at the previous row
+    size_t last_accesses = 0;
+    size_t last_faults = 0;
+    long long last_tlb_hits = 0;
+    long long last_tlb_lookups = 0;
+    std::vector<long long> last_hits;
+    std::vector<long long> last_lookups;
+
+public:
+    bool open(const std::string& path, size_t every); // false if the file cannot be created
+    bool is_open() const { return out.is_open(); }
+    void close() { out.close(); }
+
+    bool due() const { return operations % interval == 0; } // a row before the next operation
+    void count_operation() { operations++; }
+    void write(const SimulationSummary& summary);
+    void restart_window(); // the counters started over (a new MemoryManager)
+};
+
+#endif
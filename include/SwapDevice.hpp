@@ -0,0 +1,85 @@
+#ifndef SWAP_DEVICE_HPP
+#define SWAP_DEVICE_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// I/O done by a SwapDevice
+struct SwapStats{
+    size_t pages_written = 0;
+    size_t pages_read = 0;
+    size_t batches = 0;        // handed to the I/O thread
+    size_t writes = 0;         // pwrite calls: runs of consecutive slots are written as one
+    size_t write_errors = 0;
+    size_t slots_in_use = 0;
+    size_t slot_high_water = 0; // the file is this many slots long
+    double io_seconds = 0;     // the I/O thread writing
+    double stall_seconds = 0;  // the simulation waiting for the I/O thread
+    double overlap() const;    // percent of the writing done while the simulation ran on
+};
+
+// Swap file of page-sized slots. Slots are handed out by a free list (lowest new slot
+// when it is empty). Writes are copied into a batch; a full batch goes to the I/O thread,
+// which writes it in slot order while the simulation goes on. Up to MAX_QUEUED batches
+// may wait, beyond that write() blocks. read() sees every write, even one still queued.
+// The file is created (truncated) by open and removed by close.
+class SwapDevice{
+private:
+    struct Batch{
+        std::vector<size_t> slots;
+        std::vector<uint8_t> data; // one page per slot, in the same order
+    };
+    static const size_t BATCH_PAGES = 32;
+    static const size_t MAX_QUEUED = 8;
+
+    int fd = -1;
+    std::string path;
+    size_t page_size = 0;
+    std::vector<size_t> free_slots;
+
+    //Shared with the I/O thread
+    std::mutex lock;
+    std::condition_variable work_ready; // queue not empty, or stopping
+    std::condition_variable room;       // a batch was written
+    Batch staged;                       // filled by write()
+    std::deque<Batch> queue;
+    Batch in_flight;                    // being written; read-only until it is done
+    bool writing = false;
+    bool stopping = false;
+    std::unordered_map<size_t, size_t> pending; // slot -> its writes not yet in the file
+    SwapStats stats;
+    std::thread io_thread;
+
+    void run();
+    void submit(); // hands the staged batch over
+    void write_batch(const Batch& batch);
+    static bool find_newest(const Batch& batch, size_t slot, size_t page_size, uint8_t* out);
+
+public:
+    SwapDevice() = default;
+    ~SwapDevice(); // close()
+    SwapDevice(const SwapDevice&) = delete;
+    SwapDevice& operator=(const SwapDevice&) = delete;
+
+    bool open(const std::string& file_path, size_t page_bytes); // false if the file cannot be created
+    void close();  // writes everything out, stops the I/O thread and removes the file
+    bool is_open() const { return fd != -1; }
+    const std::string& get_path() const { return path; }
+
+    size_t allocate_slot();
+    void free_slot(size_t slot);
+
+    void write(size_t slot, const uint8_t* page); // asynchronous, page_size bytes
+    bool read(size_t slot, uint8_t* page);        // synchronous; false on a short read
+    void flush();  // until every write so far is in the file
+
+    SwapStats get_stats(); // a consistent copy
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef SWEEP_HPP
+#define SWEEP_HPP
+
+#include "TraceReplayer.hpp"
+#include <string>
+#include <vector>
+
+// One point of the grid. Empty / 0 fields keep what the trace itself sets up.
+struct SweepConfig{
+    std::string strategy;    // first_fit, best_fit, worst_fit or buddy
+    size_t ram_size = 0;     // size of every init
+    size_t page_size = 0;
+    std::string page_policy;
+    std::string l1;          // level spec, see CacheHierarchy::parse_level
+    std::string l2;          // level spec or "none"
+};
+
+struct SweepResult{
+    SimulationSummary summary;
+    size_t page_size = 0;    // in effect at the end of the replay
+    size_t events = 0;
+    size_t failed_mallocs = 0;
+    double elapsed_seconds = 0;
+    std::string error;       // the configuration could not be applied, nothing was measured
+};
+
+// Replays one trace under every combination of a grid of configurations.
+// The trace is loaded once and shared read-only; each configuration gets its own
+// TraceReplayer (and so its own MemoryManager) and runs as one task of a ThreadPool.
+//
+// Grid file, one key per line, values separated by commas or spaces, '#' starts a comment:
+//     strategy:    first_fit, best_fit, worst_fit, buddy
+//     ram:         4096, 16384
+//     page_size:   128, 256
+//     page_policy: fifo, lru
+//     l1:          128:16:2:4, 256:16:4:4:lru
+//     l2:          512:16:4:12, none
+// A missing key keeps the trace's (or the default) setting.
+class Sweep{
+private:
+    std::vector<std::string> strategies{""};
+    std::vector<size_t> ram_sizes{0};
+    std::vector<size_t> page_sizes{0};
+    std::vector<std::string> page_policies{""};
+    std::vector<std::string> l1_specs{"128:16:2:4"};
+    std::vector<std::string> l2_specs{"512:16:4:12"};
+
+    static SweepResult run_one(const SweepConfig& config, const std::vector<TraceEvent>& events);
+    static void write_csv(std::ostream& out, const std::vector<SweepConfig>& configs,
+                          const std::vector<SweepResult>& results);
+
+public:
+    //Prints what is wrong and returns false on an unknown key or bad value
+    bool load_grid(const std::string& path);
+
+    //Cartesian product of the grid, strategy varying slowest and l2 fastest
+    std::vector<SweepConfig> configurations() const;
+
+    //Writes one CSV row per configuration, in grid order, to out_path (stdout if empty).
+    //threads == 0 uses one per hardware thread. False if a file cannot be opened.
+    bool run(const std::string& trace_path, size_t threads, const std::string& out_path);
+};
+
+#endif
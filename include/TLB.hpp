@@ -0,0 +1,67 @@
+#ifndef TLB_HPP
+#define TLB_HPP
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>
+
+// Set-associative Translation Lookaside Buffer in front of the PageTables.
+// With ASID tagging every entry remembers its PID; without it the whole
+// TLB is flushed whenever a different PID starts translating.
+class TLB{
+private:
+    enum class Policy { LRU, FIFO, Random };
+
+    struct Entry{
+        size_t page;
+        int frame;
+        int asid; // PID that owns the translation
+        bool valid;
+    };
+
+    size_t num_entries;
+    size_t associativity;
+    size_t num_sets;
+    Policy policy;
+    std::string policy_name;
+    bool asid_tagging;
+    int current_asid = -1;
+
+    std::vector<Entry> entries;             // num_sets * associativity, set by set
+    std::vector<unsigned long long> stamps; // LRU: last use, FIFO: fill time
+    unsigned long long tick = 0;
+    unsigned rng_state = 88675123u;
+
+    //Stats
+    long long hits = 0;
+    long long misses = 0;
+    long long flushes = 0;
+    long long shootdowns = 0;
+
+    Entry* find(int pid, size_t page);
+
+public:
+    // policy: "lru", "fifo" or "random". An invalid geometry falls back to 16 entries
+    // 4-way and an unknown policy to LRU; check with valid_config first
+    TLB(size_t entries, size_t assoc, const std::string& policy, bool asid);
+    static bool valid_config(size_t entries, size_t assoc, const std::string& policy);
+
+    //Returns the cached frame, or -1 on a TLB miss
+    int lookup(int pid, size_t page);
+    void insert(int pid, size_t page, int frame);
+
+    void invalidate(int pid, size_t page); // page was evicted / unmapped
+    void invalidate_pid(int pid);          // process was torn down
+    void flush();
+
+    void display_stats();
+    long long get_hits() const { return hits; }
+    long long get_misses() const { return misses; }
+    size_t get_entries() const { return num_entries; }
+    size_t get_associativity() const { return associativity; }
+    const std::string& get_policy_name() const { return policy_name; }
+    bool is_asid_tagged() const { return asid_tagging; }
+};
+
+#endif
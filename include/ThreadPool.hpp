@@ -0,0 +1,49 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads with one task deque each. Submitted tasks are dealt
+// round robin over the deques; a worker takes from the back of its own deque and,
+// once that is empty, steals from the front of the others, so a few long tasks
+// on one worker do not leave the rest idle.
+class ThreadPool{
+private:
+    struct Worker{
+        std::deque<std::function<void()>> tasks;
+        std::mutex lock;
+    };
+
+    std::vector<Worker*> workers;
+    std::vector<std::thread> threads;
+    size_t next_worker = 0; // deque of the next submitted task
+
+    std::mutex state_lock;               // guards the waits below
+    std::condition_variable work_ready;  // queued > 0 or stopping
+    std::condition_variable all_done;    // unfinished == 0
+    std::atomic<size_t> queued{0};       // tasks sitting in a deque
+    std::atomic<size_t> unfinished{0};   // tasks submitted and not yet finished
+    bool stopping = false;
+
+    bool take(size_t self, std::function<void()>& task); // own back first, then steal
+    void run(size_t self);
+
+public:
+    ThreadPool(size_t thread_count); // 0: one per hardware thread
+    ~ThreadPool();                   // finishes the queued tasks first
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+    void wait(); // until every submitted task has finished
+
+    size_t get_threads() const { return threads.size(); }
+};
+
+#endif
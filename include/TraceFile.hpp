@@ -0,0 +1,137 @@
+#ifndef TRACE_FILE_HPP
+#define TRACE_FILE_HPP
+
+#include "TraceReplayer.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Binary trace format:
+//   TraceHeader, then record_count fixed-width records.
+//   Plain traces use 24-byte TraceRecords with absolute addresses.
+//   Delta traces (TRACE_FLAG_DELTA) use 8-byte DeltaTraceRecords: the value field holds
+//   the size, or for access/write/free the signed distance from the previous address.
+//   Their pid field is 16 bits wide, 0xFFFF stands for "no pid".
+//   A value that does not fit in 32 bits is preceded by a TRACE_OP_EXTEND record
+//   carrying its upper 32 bits.
+// All fields are little-endian, as written by the host.
+
+const char TRACE_MAGIC[8] = {'M', 'E', 'M', 'T', 'R', 'A', 'C', 'E'};
+const uint16_t TRACE_VERSION = 1;
+const uint32_t TRACE_FLAG_DELTA = 1;
+const uint8_t TRACE_OP_EXTEND = 0xFF;
+
+struct TraceHeader{
+    char magic[8];
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t flags;
+    uint64_t record_count;
+    uint64_t reserved;
+};
+
+struct TraceRecord{
+    uint8_t op;
+    uint8_t reserved[3];
+    int32_t pid;
+    uint64_t size;
+    uint64_t address;
+};
+
+struct DeltaTraceRecord{
+    uint8_t op;
+    uint8_t reserved;
+    uint16_t pid;
+    int32_t value;
+};
+
+static_assert(sizeof(TraceHeader) == 32, "TraceHeader layout");
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord layout");
+static_assert(sizeof(DeltaTraceRecord) == 8, "DeltaTraceRecord layout");
+
+// Buffered writer, the header is patched with the final count on close()
+class TraceWriter{
+private:
+    FILE* file = nullptr;
+    bool delta;
+    uint64_t count = 0;
+    size_t previous_address = 0;
+    std::vector<uint8_t> buffer;
+
+    void put(const void* record, size_t size);
+    void put_delta(uint8_t op, int pid, int64_t value);
+
+public:
+    TraceWriter(bool delta_encoded);
+    ~TraceWriter();
+
+    bool open(const std::string& path);
+    bool write(const TraceEvent& event); // false if the event cannot be encoded
+    bool close();
+};
+
+// Read-only memory mapping of a binary trace; records are decoded in place
+class MappedTrace{
+private:
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    const TraceHeader* header = nullptr;
+
+    //Decoder state
+    uint64_t position = 0;
+    size_t previous_address = 0;
+
+public:
+    MappedTrace() = default;
+    ~MappedTrace();
+    MappedTrace(const MappedTrace&) = delete;
+    MappedTrace& operator=(const MappedTrace&) = delete;
+
+    static bool is_binary_trace(const std::string& path);
+
+    bool open(const std::string& path); // false if missing, unreadable or not a valid trace
+    void close();
+
+    uint64_t record_count() const { return header ? header->record_count : 0; }
+    bool is_delta() const { return header && (header->flags & TRACE_FLAG_DELTA); }
+
+    void rewind();
+
+    //Decodes the next event; false at the end of the trace
+    bool next(TraceEvent& event){
+        if(!is_delta()){
+            if(position >= header->record_count) return false;
+            const TraceRecord& record = reinterpret_cast<const TraceRecord*>(header + 1)[position++];
+            event = {static_cast<TraceOp>(record.op), record.pid, (size_t)record.size, (size_t)record.address};
+            return true;
+        }
+
+        const DeltaTraceRecord* records = reinterpret_cast<const DeltaTraceRecord*>(header + 1);
+        int64_t high = -1; // -1: no extension seen
+        while(position < header->record_count){
+            const DeltaTraceRecord& record = records[position++];
+            if(record.op == TRACE_OP_EXTEND){
+                high = (uint32_t)record.value;
+                continue;
+            }
+            int64_t value = (high == -1) ? record.value
+                                         : (int64_t)(((uint64_t)high << 32) | (uint32_t)record.value);
+            event = {static_cast<TraceOp>(record.op), (record.pid == 0xFFFF) ? -1 : (int)record.pid, 0, 0};
+            if(has_address(event.op)){
+                previous_address += value;
+                event.address = previous_address;
+            } else {
+                event.size = (size_t)value;
+            }
+            return true;
+        }
+        return false;
+    }
+};
+
+// Converts a text command trace into the binary format.
+// Returns the number of events written, or -1 on error.
+long long convert_text_trace(const std::string& text_path, const std::string& binary_path, bool delta);
+
+#endif
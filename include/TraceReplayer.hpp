@@ -0,0 +1,149 @@
+#ifndef TRACE_REPLAYER_HPP
+#define TRACE_REPLAYER_HPP
+
+#include "MemoryManager.hpp"
+#include "StatsSampler.hpp"
+#include "ShardedMemoryManager.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// One trace event, in the same command syntax the REPL accepts.
+// The values are also the op codes of the binary trace format, keep them stable.
+enum class TraceOp : uint8_t {
+    Init = 0, Strategy = 1, Malloc = 2, Free = 3, FreeAddr = 4, Access = 5, Stats = 6, Dump = 7, Exit = 8,
+    PagePolicy = 9, Write = 10, Thread = 11
+};
+
+// Ops whose event carries a virtual address (delta-encoded in binary traces)
+inline bool has_address(TraceOp op){
+    return op == TraceOp::Access || op == TraceOp::Write || op == TraceOp::FreeAddr;
+}
+
+struct TraceEvent{
+    TraceOp op;
+    int pid;
+    size_t size;    // malloc size, init RAM size, strategy id, page policy id or a thread's PID
+    size_t address; // access / write / free address
+};
+
+// Events replayed, kept by whoever runs them (one per shard in a sharded replay)
+struct ReplayCounts{
+    size_t mallocs = 0;
+    size_t frees = 0;
+    size_t accesses = 0; // reads and writes
+    size_t writes = 0;
+    size_t failed_mallocs = 0;
+};
+
+// Streams a trace through a silent MemoryManager and measures throughput
+class TraceReplayer{
+private:
+    MemoryManager* sim;
+    size_t initial_ram; // RAM until the trace's first init
+    std::string page_policy; // applied to every MemoryManager the trace creates
+    std::vector<CacheLevelConfig> cache_levels; // likewise, if not empty
+    CacheInclusion cache_inclusion = CacheInclusion::NonInclusive;
+    size_t cores = 1;
+    std::string scheduler_policy = "affinity";
+    size_t scheduler_quantum = 1000;
+    //Overrides of what the trace itself sets up (0 / empty: use the trace's)
+    size_t ram_size = 0;
+    size_t page_size = 0;
+    std::string strategy;
+    std::string profile_path; // reuse profile of the replay, written by report()
+    size_t compact_budget = 0; // incremental compaction, bytes moved per operation
+    double compact_threshold = 50.0;
+    bool private_spaces = false; // one address space per process
+    std::string swap_path;    // swap file of every MemoryManager ("<path>.<shard>" when sharded)
+    StatsSampler sampler;     // stats time series, if opened
+    std::string error;        // a setting the current MemoryManager cannot take; stops the replay
+
+    //Sharded replay (0: one MemoryManager, driven by this thread)
+    size_t shards = 0;
+    size_t shard_threads = 0;
+    size_t shard_workers = 0; // threads the last segment ran on
+    ShardedMemoryManager* sharded = nullptr;
+
+    //Builds target's OPT lookahead for the accesses of the segment starting at `begin`
+    //(a segment ends at the next init)
+    static void compute_lookahead(MemoryManager* target, const std::vector<TraceEvent>& events, size_t begin);
+
+    //The replay-wide settings, applied to each MemoryManager an init creates.
+    //False, with the reason in `problem`, if one does not fit its RAM
+    bool setup(MemoryManager* target, std::string& problem) const;
+    static std::string page_size_error(size_t bytes, size_t ram);
+
+    //Runs one event other than init on target; returns false once the trace asks to exit
+    bool apply_event(MemoryManager* target, const TraceEvent& event, ReplayCounts& tally) const;
+
+    //Events of the segment up to the next init go to the shard of their PID, in trace order,
+    //and every shard replays its own stream as one task on a ThreadPool
+    void replay_sharded(const std::vector<TraceEvent>& events);
+    size_t run_segment(const std::vector<TraceEvent>& events, size_t begin); // returns the end of the segment
+
+    ReplayCounts counts;
+    double elapsed_seconds = 0;
+
+public:
+    TraceReplayer(size_t ram_size = 1024);
+    ~TraceReplayer();
+
+    static int strategy_id(const std::string& name);         // -1 if unknown
+    static const char* strategy_name(size_t id);             // name used by set_strategy
+    static int page_policy_id(const std::string& name);      // -1 if unknown
+    static const char* page_policy_name(size_t id);
+
+    //Policy for the whole replay. With "opt" the trace is loaded up front
+    //so every access knows when its page is used next.
+    bool set_page_policy(const std::string& name);
+    //Cache hierarchy for the whole replay
+    void set_caches(const std::vector<CacheLevelConfig>& levels, CacheInclusion inclusion);
+    //Multi-core mode for the whole replay; false if the combination is invalid
+    bool set_cores(size_t count, const std::string& policy, size_t quantum);
+    //RAM size of every init, allocation strategy and page size for the whole replay.
+    //The strategy's trace events are then ignored. Each returns false if invalid.
+    //The page size is checked against each init's RAM when the init is replayed (see get_error).
+    void set_ram_size(size_t bytes);
+    bool set_strategy(const std::string& name);
+    bool set_page_size(size_t bytes);
+    //Profiles reuse distances during the replay; report() prints them and writes the curves to path
+    void set_profile(const std::string& path);
+    //Incremental heap compaction for the whole replay (see MemoryManager::set_compaction)
+    void set_compaction(size_t budget, double threshold);
+    //Private address spaces for the whole replay (see MemoryManager::set_private_spaces)
+    void set_private_spaces(bool enabled);
+    //Swap file for the whole replay (see MemoryManager::set_swap); false if it cannot be created
+    bool set_swap(const std::string& path);
+    //Writes a stats row every `every` operations to path; false if it cannot be created
+    bool set_sampling(const std::string& path, size_t every);
+    //Replays on a ShardedMemoryManager of count shards with up to `threads` threads (0: one per
+    //hardware thread). Each shard gets at least a page of RAM, which may cap count. False if count is 0
+    bool set_shards(size_t count, size_t threads);
+
+    //Returns false for blank lines, unknown commands and malformed arguments
+    static bool parse_line(const std::string& line, TraceEvent& event);
+
+    //Reads a whole trace (text or binary) into memory; false if it cannot be opened
+    static bool load_events(const std::string& path, std::vector<TraceEvent>& events);
+
+    //Returns false once the trace asks to exit
+    bool apply(const TraceEvent& event);
+
+    //Each returns false if the file cannot be opened
+    bool replay_text(const std::string& path);
+    bool replay_binary(const std::string& path); // memory-mapped, see TraceFile.hpp
+    bool replay(const std::string& path);        // picks the format from the file's magic
+    void replay_events(const std::vector<TraceEvent>& events); // a trace already in memory
+
+    MemoryManager* get_sim() const { return sim; }
+    size_t get_event_count() const { return counts.mallocs + counts.frees + counts.accesses; }
+    size_t get_failed_mallocs() const { return counts.failed_mallocs; }
+    double get_elapsed_seconds() const { return elapsed_seconds; }
+    //Why the replay stopped early because a setting could not be applied, empty if it did not
+    const std::string& get_error() const { return error; }
+
+    void report();
+};
+
+#endif
@@ -1,10 +1,173 @@
 #include "./include/MemoryManager.hpp"
+#include "./include/TraceReplayer.hpp"
+#include "./include/TraceFile.hpp"
+#include "./include/Sweep.hpp"
+#include "./include/StatsSampler.hpp"
 #include <iostream>
 #include <iomanip>
+#include <fstream>
 #include <string>
 #include <sstream>
+#include <vector>
+#include <cstdlib>
+
+int main(int argc, char* argv[]){
+    // Batch mode: memsim --replay <trace.txt | trace.bin> [--policy <name>] [--strategy <name>] [--caches "<levels>"]
+    //                                                    [--cores <n>[:affinity|rr[:quantum]]] [--page-size <bytes>]
+    //                                                    [--profile <curves.csv>] [--sample <every>:<series.csv>]
+    //                                                    [--stats-out <stats.json>] [--compact <budget>[:<threshold>]]
+    //                                                    [--spaces shared|private] [--shards <n>[:<threads>]]
+    //                                                    [--swap <file>]
+    if(argc >= 3 && argc % 2 == 1 && std::string(argv[1]) == "--replay"){
+        TraceReplayer replayer;
+        std::string stats_path;
+        bool sharded = false, single_sink = false; // the sampler, profiler and JSON stats follow one MemoryManager
+        for(int i = 3; i < argc; i += 2){
+            std::string option = argv[i];
+            std::vector<CacheLevelConfig> levels;
+            CacheInclusion inclusion;
+            if(option == "--policy"){
+                if(!replayer.set_page_policy(argv[i + 1])){
+                    std::cerr << "Error: Unknown page policy. Use fifo, lru, clock, second_chance, ws or opt.\n";
+                    return 1;
+                }
+            }
+            else if(option == "--caches" && CacheHierarchy::parse_config(argv[i + 1], levels, inclusion)
+                    && CacheHierarchy::valid_config(levels, inclusion)){
+                replayer.set_caches(levels, inclusion);
+            }
+            else if(option == "--cores"){
+                std::string spec = argv[i + 1];
+                for(char& c : spec) if(c == ':') c = ' ';
+                std::stringstream fields(spec);
+                size_t cores = 0, quantum = 1000;
+                std::string policy = "affinity";
+                fields >> cores >> policy >> quantum;
+                if(!replayer.set_cores(cores, policy, quantum)){
+                    std::cerr << "Error: Bad core setup " << argv[i + 1] << " (exclusive caches are single-core only)\n";
+                    return 1;
+                }
+            }
+            else if(option == "--strategy"){
+                if(!replayer.set_strategy(argv[i + 1])){
+                    std::cerr << "Error: Unknown strategy. Use first_fit, best_fit, worst_fit, buddy or slab.\n";
+                    return 1;
+                }
+            }
+            else if(option == "--stats-out"){
+                stats_path = argv[i + 1];
+                single_sink = true;
+            }
+            else if(option == "--sample"){
+                std::string spec = argv[i + 1];
+                size_t colon = spec.find(':');
+                size_t every = std::strtoull(spec.c_str(), nullptr, 10);
+                if(colon == std::string::npos || every == 0 || !replayer.set_sampling(spec.substr(colon + 1), every)){
+                    std::cerr << "Error: Bad sampling setup " << spec << " (use <every>:<file.csv>)\n";
+                    return 1;
+                }
+                single_sink = true;
+            }
+            else if(option == "--profile"){
+                replayer.set_profile(argv[i + 1]);
+                single_sink = true;
+            }
+            else if(option == "--swap"){
+                if(!replayer.set_swap(argv[i + 1])){
+                    std::cerr << "Error: Cannot create swap file " << argv[i + 1] << "\n";
+                    return 1;
+                }
+            }
+            else if(option == "--shards"){
+                std::string spec = argv[i + 1];
+                size_t colon = spec.find(':');
+                size_t threads = (colon == std::string::npos) ? 0 : std::strtoull(spec.c_str() + colon + 1, nullptr, 10);
+                if(!replayer.set_shards(std::strtoull(spec.c_str(), nullptr, 10), threads)){
+                    std::cerr << "Error: Bad shard setup " << spec << " (use <shards>[:<threads>])\n";
+                    return 1;
+                }
+                sharded = true;
+            }
+            else if(option == "--compact"){
+                std::string spec = argv[i + 1];
+                size_t colon = spec.find(':');
+                size_t budget = std::strtoull(spec.c_str(), nullptr, 10);
+                double threshold = (colon == std::string::npos) ? 50.0 : std::strtod(spec.c_str() + colon + 1, nullptr);
+                if(budget == 0){
+                    std::cerr << "Error: Bad compaction setup " << spec << " (use <budget bytes>[:<fragmentation %>])\n";
+                    return 1;
+                }
+                replayer.set_compaction(budget, threshold);
+            }
+            else if(option == "--spaces" && (std::string(argv[i + 1]) == "shared" || std::string(argv[i + 1]) == "private")){
+                replayer.set_private_spaces(std::string(argv[i + 1]) == "private");
+            }
+            else if(option == "--page-size"){
+                if(!replayer.set_page_size(std::strtoull(argv[i + 1], nullptr, 10))){
+                    std::cerr << "Error: Page size must be a power of two, at least 16 bytes\n";
+                    return 1;
+                }
+            }
+            else{
+                std::cerr << "Error: Bad option " << option << " " << argv[i + 1] << "\n";
+                return 1;
+            }
+        }
+        if(sharded && single_sink){
+            std::cerr << "Error: --sample, --profile and --stats-out need a single MemoryManager, not --shards\n";
+            return 1;
+        }
+        if(!replayer.replay(argv[2])){
+            std::cerr << "Error: Cannot open trace " << argv[2] << "\n";
+            return 1;
+        }
+        if(!replayer.get_error().empty()){
+            std::cerr << "Error: " << replayer.get_error() << "\n";
+            return 1;
+        }
+        replayer.report();
+        if(!stats_path.empty()){
+            std::ofstream out(stats_path);
+            if(!out){
+                std::cerr << "Error: Cannot write " << stats_path << "\n";
+                return 1;
+            }
+            replayer.get_sim()->write_json(out);
+        }
+        return 0;
+    }
+
+    // Parameter sweep: memsim --sweep <trace> <grid.txt> [--threads <n>] [--out <results.csv>]
+    if(argc >= 4 && argc % 2 == 0 && std::string(argv[1]) == "--sweep"){
+        size_t threads = 0;
+        std::string out_path;
+        for(int i = 4; i < argc; i += 2){
+            std::string option = argv[i];
+            if(option == "--threads") threads = std::strtoull(argv[i + 1], nullptr, 10);
+            else if(option == "--out") out_path = argv[i + 1];
+            else{
+                std::cerr << "Error: Bad option " << option << " " << argv[i + 1] << "\n";
+                return 1;
+            }
+        }
+        Sweep sweep;
+        if(!sweep.load_grid(argv[3])) return 1;
+        return sweep.run(argv[2], threads, out_path) ? 0 : 1;
+    }
+
+    // Converter: memsim --convert <trace.txt> <trace.bin> [--delta]
+    if((argc == 4 || argc == 5) && std::string(argv[1]) == "--convert"){
+        bool delta = (argc == 5 && std::string(argv[4]) == "--delta");
+        long long written = convert_text_trace(argv[2], argv[3], delta);
+        if(written < 0){
+            std::cerr << "Error: Could not convert " << argv[2] << " to " << argv[3] << "\n";
+            return 1;
+        }
+        std::cout << "Wrote " << written << " events to " << argv[3]
+                  << (delta ? " (delta-encoded)" : "") << "\n";
+        return 0;
+    }
 
-int main(){
     std::cout << "==========================================\n";
     std::cout << "      Memory Management Simulator\n";
     std::cout << "==========================================\n";
@@ -12,6 +175,7 @@ int main(){
 
     // Initialized with 1024 Bytes of Physical RAM
     MemoryManager* memSim = new MemoryManager(1024);
+    StatsSampler sampler; // kept across init, see the sample command
     std::string line;
     
     while(true){
@@ -30,17 +194,42 @@ int main(){
             std::cout << "  init <size>          - Reinitialize physical memory size\n";
             std::cout << "  malloc <size> <pid>  - Allocate Virtual Memory for a process\n";
             std::cout << "  free <pid>           - Deallocate memory for a process\n";
-            std::cout << "  strategy <name>      - Set strategy (first_fit, best_fit, worst_fit, buddy)\n";
+            std::cout << "  free <pid> <addr>    - Free one allocation of a process (hex address)\n";
+            std::cout << "  strategy <name>      - Set strategy (first_fit, best_fit, worst_fit, buddy, slab)\n";
             std::cout << "  access <pid> <addr>  - CPU accesses Virtual Address (Triggers VM translation)\n";
+            std::cout << "  write <pid> <addr>   - CPU writes to Virtual Address (marks the line and page dirty)\n";
             std::cout << "  dump                 - Show Memory Block Map (Virtual)\n";
             std::cout << "  stats                - Show Physical RAM stats & Cache Hit Rates\n";
+            std::cout << "  stats --json [file]  - The same as JSON, with the simulator's internal timings\n";
+            std::cout << "  latency <dram> <walk> <fault> <writeback> - Set cycle costs of the virtual clock\n";
+            std::cout << "  caches [inclusion] <size:block:assoc:latency[:policy][:wb|wt][:prefetcher]>... - Rebuild the cache hierarchy, L1 first\n";
+            std::cout << "  tlb <entries> <assoc> <lru|fifo|random> <asid|flush> - Reconfigure the TLB\n";
+            std::cout << "  thread <tid> <pid>   - Thread tid runs in the address space of process pid\n";
+            std::cout << "  cores <n> [affinity|rr] [quantum] - Multi-core mode: private L1s, shared lower levels, MESI\n";
+            std::cout << "  cache_policy <l1|l2|..> <name> - Cache replacement (fifo, lru, plru, srrip, brrip); empties the caches\n";
+            std::cout << "  page_policy <name> [window] - Page replacement (fifo, lru, clock, second_chance, ws, opt)\n";
+            std::cout << "  pagetable <levels> <bits> - Radix page table geometry (before any access)\n";
+            std::cout << "  page_size <bytes>    - Page size, a power of two (before any access)\n";
+            std::cout << "  sample <every> <file.csv> | off - Write a stats time series row every N malloc/free/access\n";
+            std::cout << "  profile <on|off|show> [file.csv] - Reuse distance profiling: miss-ratio curves for every cache and RAM size\n";
+            std::cout << "  compact [auto <budget> [threshold] | off] - Compact the heap now, or a little on every operation\n";
+            std::cout << "  spaces <shared|private> - One address space for all PIDs, or one per process (before any malloc)\n";
+            std::cout << "  swap <file|off> - Back frames with real bytes and page out to a swap file (before any access)\n";
         }
         else if(command == "init"){
-            size_t size;
+            size_t size = 0;
             ss >> size;
-            delete memSim;
-            memSim = new MemoryManager(size);
-            std::cout << "System Re-initialized with " << size << " bytes of Physical RAM.\n";
+            MemoryManager* next = new MemoryManager(size);
+            if(size < next->get_page_size()){
+                std::cout << "Error: RAM must hold at least one " << next->get_page_size() << "-byte page.\n";
+                delete next;
+            } else {
+                memSim->write_sample();
+                delete memSim;
+                memSim = next;
+                if(sampler.is_open()) memSim->set_sampler(&sampler);
+                std::cout << "System Re-initialized with " << size << " bytes of Physical RAM.\n";
+            }
         }
         else if(command == "malloc"){
             size_t size;
@@ -57,7 +246,11 @@ int main(){
         }
         else if(command == "free"){
             int pid;
-            if (ss >> pid) memSim->deallocate(pid);
+            size_t addr;
+            if(ss >> pid){
+                if(ss >> std::hex >> addr) memSim->deallocate(pid, addr);
+                else memSim->deallocate(pid);
+            }
         }
         else if(command == "strategy"){
             std::string strat;
@@ -66,28 +259,250 @@ int main(){
             else if(strat == "best_fit") memSim->set_strategy("Best Fit");
             else if(strat == "worst_fit") memSim->set_strategy("Worst Fit");
             else if(strat == "buddy") memSim->set_strategy("Buddy");
+            else if(strat == "slab") memSim->set_strategy("Slab");
             std::cout << "Allocation Strategy set to: " << strat << "\n";
         }
         else if(command == "dump"){
             memSim->dump_memory();
         }
         else if(command == "stats"){
-            memSim->display_stats();
+            std::string format, path;
+            ss >> format >> path;
+            if(format == "--json" && path.empty()){
+                memSim->write_json(std::cout);
+            }
+            else if(format == "--json"){
+                std::ofstream out(path);
+                if(out){
+                    memSim->write_json(out);
+                    std::cout << "Stats written to " << path << "\n";
+                } else {
+                    std::cout << "Error: Cannot write " << path << "\n";
+                }
+            }
+            else{
+                memSim->display_stats();
+            }
+        }
+        else if(command == "latency"){
+            LatencyConfig config;
+            if(ss >> config.dram >> config.page_walk >> config.page_fault >> config.page_writeback){
+                memSim->set_latency(config);
+                std::cout << "Latency set (cycles): DRAM " << config.dram << ", Page Walk " << config.page_walk
+                          << ", Page Fault " << config.page_fault
+                          << ", Write-back " << config.page_writeback << "\n";
+            } else {
+                std::cout << "Usage: latency <dram> <walk> <fault> <writeback>\n";
+            }
+        }
+        else if(command == "caches"){
+            std::string rest;
+            std::getline(ss, rest);
+            std::vector<CacheLevelConfig> levels;
+            CacheInclusion inclusion;
+            if(CacheHierarchy::parse_config(rest, levels, inclusion) && memSim->configure_caches(levels, inclusion)){
+                std::cout << "Cache hierarchy set to " << levels.size() << " levels, "
+                          << CacheHierarchy::inclusion_name(inclusion) << ".\n";
+            } else {
+                std::cout << "Usage: caches [inclusive|exclusive|non_inclusive] <size:block:assoc:latency[:policy][:wb|wt][:prefetcher]>...\n";
+                std::cout << "(prefetcher: next_line|stride|stream[/degree[/distance]])\n";
+                std::cout << "(inclusive: block sizes may only grow going down; exclusive: one block size, no prefetchers)\n";
+            }
+        }
+        else if(command == "page_policy"){
+            std::string policy;
+            size_t window = 1000;
+            ss >> policy;
+            ss >> window;
+            if(memSim->set_page_policy(policy, window)){
+                std::cout << "Page Replacement Policy set to: " << policy << "\n";
+                if(policy == "opt") std::cout << "Note: OPT needs a lookahead; without --replay it behaves like LRU.\n";
+            } else {
+                std::cout << "Unknown policy. Use fifo, lru, clock, second_chance, ws or opt.\n";
+            }
+        }
+        else if(command == "thread"){
+            int tid, pid;
+            if(ss >> tid >> pid && memSim->add_thread(tid, pid)){
+                std::cout << "Thread " << tid << " shares the address space of PID " << pid << ".\n";
+            } else {
+                std::cout << "Usage: thread <tid> <pid> (pid must be a process, not a thread)\n";
+            }
+        }
+        else if(command == "swap"){
+            std::string path;
+            ss >> path;
+            if(!path.empty() && memSim->set_swap(path == "off" ? "" : path)){
+                if(path == "off") std::cout << "Swap off.\n";
+                else std::cout << "Swapping to " << path << " (removed on exit).\n";
+            } else {
+                std::cout << "Usage: swap <file|off> (before the first access; the file must be writable)\n";
+            }
+        }
+        else if(command == "spaces"){
+            std::string mode;
+            ss >> mode;
+            if((mode == "shared" || mode == "private") && memSim->set_private_spaces(mode == "private")){
+                if(mode == "private") std::cout << "Every process gets its own growable 64-bit address space.\n";
+                else std::cout << "All processes share one 64 KB address space.\n";
+            } else {
+                std::cout << "Usage: spaces <shared|private> (before the first malloc or access)\n";
+            }
+        }
+        else if(command == "cores"){
+            size_t cores = 0, quantum = 1000;
+            std::string policy = "affinity";
+            ss >> cores >> policy >> quantum;
+            if(memSim->set_cores(cores, policy, quantum)){
+                std::cout << "Simulating " << cores << " core(s)";
+                if(cores > 1) std::cout << ", scheduler: " << policy;
+                std::cout << ".\n";
+            } else {
+                std::cout << "Usage: cores <n> [affinity|rr] [quantum] (exclusive caches are single-core only)\n";
+            }
+        }
+        else if(command == "cache_policy"){
+            std::string level, policy;
+            ss >> level >> policy;
+            int level_number = (level.size() > 1 && level[0] == 'l') ? std::atoi(level.c_str() + 1) : 0;
+            if(memSim->set_cache_policy(level_number, policy)){
+                std::cout << "Cache " << level << " replacement set to: " << policy << "\n";
+            } else {
+                std::cout << "Usage: cache_policy <l1|l2|..> <fifo|lru|plru|srrip|brrip>\n";
+            }
+        }
+        else if(command == "pagetable"){
+            int levels, bits;
+            if(ss >> levels >> bits){
+                if(memSim->configure_page_table(levels, bits))
+                    std::cout << "Page tables set to " << levels << " levels of " << bits << " bits.\n";
+                else
+                    std::cout << "Error: Geometry must satisfy bits <= " << PageTable::MAX_BITS_PER_LEVEL
+                              << ", levels * bits <= 64 and be set before any access (use init).\n";
+            } else {
+                std::cout << "Usage: pagetable <levels> <bits_per_level>\n";
+            }
+        }
+        else if(command == "page_size"){
+            size_t bytes;
+            if(ss >> bytes){
+                if(memSim->set_page_size(bytes))
+                    std::cout << "Page size set to " << bytes << " bytes.\n";
+                else
+                    std::cout << "Error: Page size must be a power of two between 16 bytes and the RAM size, set before any access (use init).\n";
+            } else {
+                std::cout << "Usage: page_size <bytes>\n";
+            }
+        }
+        else if(command == "compact"){
+            std::string mode;
+            ss >> mode;
+            if(mode.empty()){
+                SimulationSummary before = memSim->summarize();
+                CompactionStats done = memSim->get_compaction_stats();
+                if(memSim->compact()){
+                    SimulationSummary after = memSim->summarize();
+                    const CompactionStats& now = memSim->get_compaction_stats();
+                    std::cout << "Compacted: moved " << (now.blocks_moved - done.blocks_moved) << " blocks ("
+                              << (now.bytes_moved - done.bytes_moved) << " bytes). Largest free block "
+                              << before.largest_free_block << " -> " << after.largest_free_block << " bytes, external fragmentation "
+                              << before.fragmentation << "% -> " << after.fragmentation << "%\n";
+                } else {
+                    std::cout << "Error: Compaction needs a fit strategy (buddy blocks must stay aligned).\n";
+                }
+            }
+            else if(mode == "off"){
+                memSim->set_compaction(0);
+                std::cout << "Incremental compaction off.\n";
+            }
+            else if(mode == "auto"){
+                size_t budget = 0;
+                double threshold = 50.0;
+                ss >> budget;
+                if(!(ss >> threshold)) threshold = 50.0;
+                if(budget == 0){
+                    std::cout << "Usage: compact auto <budget bytes> [fragmentation %]\n";
+                } else {
+                    memSim->set_compaction(budget, threshold);
+                    std::cout << "Incremental compaction: up to " << budget << " bytes per operation once external fragmentation reaches "
+                              << threshold << "%\n";
+                }
+            }
+            else{
+                std::cout << "Usage: compact [auto <budget> [threshold] | off]\n";
+            }
+        }
+        else if(command == "sample"){
+            std::string first, path;
+            ss >> first >> path;
+            size_t every = std::strtoull(first.c_str(), nullptr, 10);
+            if(first == "off"){
+                memSim->write_sample(); // the final state
+                memSim->set_sampler(nullptr);
+                sampler.close();
+                std::cout << "Sampling off.\n";
+            }
+            else if(every > 0 && !path.empty()){
+                if(sampler.open(path, every)){
+                    memSim->set_sampler(&sampler);
+                    std::cout << "Sampling every " << every << " operations to " << path << "\n";
+                } else {
+                    std::cout << "Error: Cannot write " << path << "\n";
+                }
+            }
+            else{
+                std::cout << "Usage: sample <every> <file.csv> | sample off\n";
+            }
+        }
+        else if(command == "profile"){
+            std::string mode, path;
+            ss >> mode >> path;
+            if(mode == "on" || mode == "off"){
+                memSim->set_profiling(mode == "on");
+                std::cout << "Reuse profiling " << mode << (mode == "on" ? " (profile restarted).\n" : ".\n");
+            }
+            else if(mode == "show"){
+                memSim->display_profile();
+                if(!path.empty()){
+                    if(memSim->write_profile(path)) std::cout << "Miss-ratio curves written to " << path << "\n";
+                    else std::cout << "Error: Cannot write " << path << "\n";
+                }
+            }
+            else{
+                std::cout << "Usage: profile <on|off|show> [file.csv]\n";
+            }
+        }
+        else if(command == "tlb"){
+            size_t entries, assoc;
+            std::string policy, mode;
+            if(ss >> entries >> assoc >> policy >> mode){
+                if((mode == "asid" || mode == "flush") && memSim->configure_tlb(entries, assoc, policy, mode == "asid")){
+                    //What the TLB took, not what was typed
+                    const TLB& tlb = memSim->get_tlb();
+                    std::cout << "TLB set to " << tlb.get_entries() << " entries, " << tlb.get_associativity() << "-way, "
+                              << tlb.get_policy_name() << (tlb.is_asid_tagged() ? ", ASID tagged\n" : ", flushed on PID switch\n");
+                } else {
+                    std::cout << "Error: Entries must be a multiple of the associativity (both > 0), the policy lru, fifo or random, and the mode asid or flush.\n";
+                }
+            } else {
+                std::cout << "Usage: tlb <entries> <assoc> <lru|fifo|random> <asid|flush>\n";
+            }
         }
 
-        else if(command == "access"){
+        else if(command == "access" || command == "write"){
             int pid;
             size_t v_addr;
             if(ss >> pid >> std::hex >> v_addr){
-                memSim->access_memory(v_addr, pid);
+                memSim->access_memory(v_addr, pid, command == "write");
             } else {
-                std::cout << "Usage: access <pid> <virtual_address>\n";
+                std::cout << "Usage: " << command << " <pid> <virtual_address>\n";
             }
         }
         else{
             std::cout << "Unknown command. Type 'help'.\n";
         }
     }
+    memSim->write_sample();
     delete memSim;
     return 0;
 }
\ No newline at end of file
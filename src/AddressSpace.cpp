@@ -0,0 +1,281 @@
+#include "../include/AddressSpace.hpp"
+
+AddressSpace::AddressSpace(BlockPool& node_pool, size_t initial_heap, size_t address_top, size_t page_size,
+                           bool can_grow, AllocStrategy alloc_strategy)
+    : pool(node_pool), top(address_top), guard(page_size), growable(can_grow),
+      strategy(alloc_strategy), heap_size(initial_heap) {
+    regions[0] = Region{0, heap_size, RegionKind::Heap};
+    head = pool.create(0, heap_size, true, -1);
+    if(strategy == AllocStrategy::Buddy){
+        buddy = new BuddyAllocator(heap_size, pool);
+        buddy->release(head);
+    } else {
+        free_index.insert(head);
+    }
+}
+
+//The slabs' spans are list nodes too, so the allocator goes first.
+//Only a space dropped on its own walks its list (delete_space); see abandon_nodes
+AddressSpace::~AddressSpace(){
+    delete slabs;
+    delete buddy;
+    MemoryBlock* current = head;
+    while(current != nullptr){
+        MemoryBlock* next = current->next;
+        pool.destroy(current);
+        current = next;
+    }
+}
+
+//Finds and splits a block of the list under the current strategy (Slab falls back to First Fit)
+MemoryBlock* AddressSpace::take_block(size_t request_size){
+    MemoryBlock* selected_block = nullptr;
+
+    if(strategy == AllocStrategy::Buddy){
+        // Per-order free lists: O(log heap size) search and split
+        selected_block = buddy->allocate(request_size);
+        if(selected_block){
+            heap_used += selected_block->size;
+            heap_changes++;
+        }
+        return selected_block;
+    }
+
+    // The free index answers each fit query in O(log n), picking exactly the
+    // block a full list walk would have picked
+    if(strategy == AllocStrategy::BestFit){
+        selected_block = free_index.best_fit(request_size);
+    }
+    else if(strategy == AllocStrategy::WorstFit){
+        selected_block = free_index.worst_fit(request_size);
+    }
+    else{
+        selected_block = free_index.first_fit(request_size);
+    }
+    if(selected_block == nullptr) return nullptr;
+
+    //Split the block to use only the required amount of memory
+    free_index.erase(selected_block);
+    if(selected_block->size > request_size){
+        MemoryBlock* new_free_block = pool.create(
+            selected_block->start_address+request_size,
+            selected_block->size-request_size,
+            true, -1
+        );
+        new_free_block->next = selected_block->next;
+        new_free_block->prev = selected_block;
+        if(selected_block->next) selected_block->next->prev = new_free_block;
+        selected_block->next = new_free_block;
+        selected_block->size = request_size;
+        free_index.insert(new_free_block);
+    }
+    selected_block->is_free = false;
+    heap_used += selected_block->size;
+    heap_changes++;
+    return selected_block;
+}
+
+//Returns one allocated block to the free pool and coalesces it
+void AddressSpace::release_block(MemoryBlock* current){
+    heap_used -= current->size;
+    heap_changes++;
+    current->is_free=true;
+    current->process_id = -1;
+
+    //coalescing logic
+    //Seperate path for buddy: the engine merges by the XOR address rule
+    if(strategy == AllocStrategy::Buddy){
+        buddy->release(current);
+        return;
+    }
+
+    bool merged = true;
+    while(merged){
+        merged = false;
+
+        //1. Checks if the next block is also free
+        if(current->next!=nullptr && current->next->is_free){
+            MemoryBlock* temp = current->next;
+            free_index.erase(temp);
+            current->size+=temp->size;
+            current->next = temp->next;
+            if(temp->next!=nullptr){
+                temp->next->prev = current;
+            }
+            pool.destroy(temp);
+            merged = true;
+        }
+
+        //2. checks if previous block is also free
+        if(current->prev!=nullptr && current->prev->is_free){
+            MemoryBlock* prev_block = current->prev;
+            free_index.erase(prev_block);
+            prev_block->size+=current->size;
+            prev_block->next = current->next;
+            if(current->next != nullptr){
+                current->next->prev = prev_block;
+            }
+            MemoryBlock* to_delete = current;
+            current = prev_block;
+            pool.destroy(to_delete);
+            merged = true;
+        }
+    }
+    free_index.insert(current);
+}
+
+//The lowest Mapping, less its guard page
+size_t AddressSpace::heap_limit() const{
+    auto above = regions.upper_bound(0);
+    return (above == regions.end()) ? top : above->first - guard;
+}
+
+//The new range is appended as one free block. Its upper half is an aligned block of
+//at least size bytes, which the buddy engine needs. Growing is rare (the heap doubles),
+//so walking to the tail of the list is fine here
+bool AddressSpace::grow(size_t size){
+    if(!growable) return false;
+    size_t new_size = heap_size;
+    while(new_size == heap_size || new_size / 2 < size){
+        if(new_size > heap_limit() / 2) return false;
+        new_size *= 2;
+    }
+
+    MemoryBlock* tail = head;
+    while(tail->next != nullptr) tail = tail->next;
+    MemoryBlock* added = pool.create(heap_size, new_size - heap_size, true, -1);
+    added->prev = tail;
+    tail->next = added;
+    heap_size = new_size;
+    regions[0].size = heap_size;
+
+    if(strategy == AllocStrategy::Buddy){
+        buddy->grow(heap_size);
+        buddy->release(added);
+    } else if(tail->is_free){
+        free_index.erase(tail);
+        tail->size += added->size;
+        tail->next = nullptr;
+        pool.destroy(added);
+        free_index.insert(tail);
+    } else {
+        free_index.insert(added);
+    }
+    return true;
+}
+
+void AddressSpace::set_strategy(AllocStrategy next){
+    bool was_buddy = (strategy == AllocStrategy::Buddy);
+    bool is_buddy = (next == AllocStrategy::Buddy);
+    strategy = next;
+    if(was_buddy == is_buddy) return;
+
+    // Free blocks are owned by either the fit index or the buddy engine,
+    // so hand them over when switching between the two families
+    if(is_buddy){
+        //Buddy blocks must stay aligned, so a compaction pass in progress is dropped
+        compacting = false;
+        compact_cursor = 0;
+        free_index.clear();
+        buddy = new BuddyAllocator(heap_size, pool);
+        MemoryBlock* current = head;
+        while(current!=nullptr){
+            if(current->is_free) current = buddy->release(current);
+            current = current->next;
+        }
+    } else {
+        buddy->clear();
+        delete buddy;
+        buddy = nullptr;
+        MemoryBlock* current = head;
+        while(current!=nullptr){
+            if(current->is_free){
+                // Buddy leaves unmerged free neighbours behind, coalesce them
+                while(current->next!=nullptr && current->next->is_free){
+                    MemoryBlock* temp = current->next;
+                    current->size += temp->size;
+                    current->next = temp->next;
+                    if(temp->next!=nullptr) temp->next->prev = current;
+                    pool.destroy(temp);
+                }
+                free_index.insert(current);
+            }
+            current = current->next;
+        }
+    }
+}
+
+void AddressSpace::swap_with_gap(MemoryBlock* gap, MemoryBlock* block){
+    free_index.erase(gap);
+    MemoryBlock* before = gap->prev;
+    MemoryBlock* after = block->next;
+    block->prev = before;
+    if(before) before->next = block;
+    else head = block;
+    block->next = gap;
+    gap->prev = block;
+    gap->next = after;
+    if(after) after->prev = gap;
+    block->start_address = gap->start_address;
+    gap->start_address = block->start_address + block->size;
+
+    //The gap joins the free space above
+    if(after != nullptr && after->is_free){
+        free_index.erase(after);
+        gap->size += after->size;
+        gap->next = after->next;
+        if(after->next) after->next->prev = gap;
+        pool.destroy(after);
+    }
+    free_index.insert(gap);
+}
+
+size_t AddressSpace::largest_free() const{
+    return (strategy == AllocStrategy::Buddy) ? buddy->largest() : free_index.largest();
+}
+
+size_t AddressSpace::free_count() const{
+    return (strategy == AllocStrategy::Buddy) ? buddy->count() : free_index.count();
+}
+
+double AddressSpace::fragmentation() const{
+    size_t free_memory = heap_size - heap_used;
+    if(free_memory == 0) return 0.0;
+    return (1.0 - (static_cast<double>(largest_free()) / free_memory)) * 100.0;
+}
+
+//Highest gap that fits, walking down from the top: O(regions), and large mallocs are few
+size_t AddressSpace::map(size_t size){
+    size = (size + guard - 1) / guard * guard;
+    size_t ceiling = top;
+    for(auto it = regions.rbegin(); it != regions.rend(); ++it){
+        const Region& below = it->second;
+        size_t floor = below.start + below.size;
+        if(ceiling >= floor && ceiling - floor >= size + guard){
+            size_t start = ceiling - size;
+            regions[start] = Region{start, size, RegionKind::Mapping};
+            mapped_bytes += size;
+            return start;
+        }
+        if(below.start < guard) break; // the heap: nothing lies under it
+        ceiling = below.start - guard;
+    }
+    return INVALID;
+}
+
+size_t AddressSpace::unmap(size_t start){
+    auto found = regions.find(start);
+    if(found == regions.end() || found->second.kind != RegionKind::Mapping) return 0;
+    size_t size = found->second.size;
+    regions.erase(found);
+    mapped_bytes -= size;
+    return size;
+}
+
+const Region* AddressSpace::find(size_t address) const{
+    auto found = regions.upper_bound(address);
+    if(found == regions.begin()) return nullptr;
+    --found;
+    if(address >= found->second.start + found->second.size) return nullptr;
+    return &found->second;
+}
@@ -0,0 +1,32 @@
+#include "../include/BlockPool.hpp"
+#include <new>
+
+BlockPool::~BlockPool(){
+    for(auto& chunk : chunks) ::operator delete(chunk.first);
+}
+
+void BlockPool::grow(){
+    size_t count = chunks.empty() ? FIRST_CHUNK : chunks.back().second * 2;
+    if(count > MAX_CHUNK) count = MAX_CHUNK;
+    MemoryBlock* storage = static_cast<MemoryBlock*>(::operator new(count * sizeof(MemoryBlock)));
+    chunks.push_back({storage, count});
+    used_in_last = 0;
+}
+
+MemoryBlock* BlockPool::create(size_t addr, size_t sz, bool free, int pid){
+    MemoryBlock* slot;
+    if(free_list != nullptr){
+        // Most recently released first: its cache lines are the likeliest to be warm
+        slot = free_list;
+        free_list = free_list->next;
+    } else {
+        if(chunks.empty() || used_in_last == chunks.back().second) grow();
+        slot = chunks.back().first + used_in_last++;
+    }
+    return new (slot) MemoryBlock(addr, sz, free, pid);
+}
+
+void BlockPool::destroy(MemoryBlock* block){
+    block->next = free_list;
+    free_list = block;
+}
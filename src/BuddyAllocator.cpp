@@ -0,0 +1,167 @@
+#include "../include/BuddyAllocator.hpp"
+#include <algorithm>
+
+BuddyAllocator::BuddyAllocator(size_t heap_sz, BlockPool& node_pool) : heap_size(heap_sz), pool(node_pool) {
+    max_order = order_of(heap_size);
+    free_lists.assign(max_order + 1, nullptr);
+    layout_bitmap();
+}
+
+void BuddyAllocator::layout_bitmap(){
+    // The bitmaps of every order back to back
+    order_offset.resize(max_order + 1);
+    size_t bits = 0;
+    for(int order = 0; order <= max_order; order++){
+        order_offset[order] = bits;
+        bits += heap_size >> order;
+    }
+    free_bitmap.assign((bits + 63) / 64, 0);
+}
+
+void BuddyAllocator::grow(size_t new_heap_size){
+    heap_size = new_heap_size;
+    max_order = order_of(heap_size);
+    free_lists.resize(max_order + 1, nullptr);
+    layout_bitmap();
+    for(int order = 0; order <= max_order; order++){
+        for(MemoryBlock* block = free_lists[order]; block != nullptr; block = block->next_free){
+            set_bit(order, block->start_address, true);
+        }
+    }
+}
+
+int BuddyAllocator::order_of(size_t size){
+    int order = 0;
+    while(((size_t)1 << order) < size) order++;
+    return order;
+}
+
+bool BuddyAllocator::test_bit(int order, size_t addr) const{
+    size_t bit = order_offset[order] + (addr >> order);
+    return (free_bitmap[bit / 64] >> (bit % 64)) & 1;
+}
+
+void BuddyAllocator::set_bit(int order, size_t addr, bool value){
+    size_t bit = order_offset[order] + (addr >> order);
+    if(value) free_bitmap[bit / 64] |= ((uint64_t)1 << (bit % 64));
+    else      free_bitmap[bit / 64] &= ~((uint64_t)1 << (bit % 64));
+}
+
+void BuddyAllocator::push_free(MemoryBlock* block, int order){
+    block->prev_free = nullptr;
+    block->next_free = free_lists[order];
+    if(free_lists[order]) free_lists[order]->prev_free = block;
+    free_lists[order] = block;
+    free_count++;
+    set_bit(order, block->start_address, true);
+}
+
+void BuddyAllocator::remove_free(MemoryBlock* block, int order){
+    if(block->prev_free) block->prev_free->next_free = block->next_free;
+    else free_lists[order] = block->next_free;
+    if(block->next_free) block->next_free->prev_free = block->prev_free;
+    block->next_free = block->prev_free = nullptr;
+    free_count--;
+    set_bit(order, block->start_address, false);
+}
+
+MemoryBlock* BuddyAllocator::split(MemoryBlock* block, size_t lower_size){
+    //Create the upper block
+    MemoryBlock* buddy = pool.create(block->start_address + lower_size, block->size - lower_size, true, -1);
+
+    // Insert into the linked list
+    buddy->next = block->next;
+    buddy->prev = block;
+    if(block->next) block->next->prev = buddy;
+    block->next = buddy;
+
+    block->size = lower_size;
+    return buddy;
+}
+
+MemoryBlock* BuddyAllocator::allocate(size_t request_size){
+    if(request_size > heap_size) return nullptr;
+    int target_order = order_of(request_size);
+
+    // 1. Smallest order with a free block
+    int order = target_order;
+    while(order <= max_order && free_lists[order] == nullptr) order++;
+    if(order > max_order) return nullptr;
+
+    MemoryBlock* block = free_lists[order];
+    remove_free(block, order);
+
+    // 2. Split down to the target order, filing each upper half as a free buddy
+    while(order > target_order){
+        order--;
+        push_free(split(block, block->size / 2), order);
+    }
+
+    block->is_free = false;
+    return block;
+}
+
+MemoryBlock* BuddyAllocator::release_aligned(MemoryBlock* block){
+    block->is_free = true;
+    block->process_id = -1;
+    int order = order_of(block->size);
+
+    while(order < max_order){
+        // A block's buddy is found by xoring the address with the size
+        size_t buddy_addr = block->start_address ^ block->size;
+        if(!test_bit(order, buddy_addr)) break;
+
+        // A free buddy of the same order is always the list neighbour
+        MemoryBlock* buddy = (buddy_addr > block->start_address) ? block->next : block->prev;
+        remove_free(buddy, order);
+
+        MemoryBlock* lower = (buddy_addr > block->start_address) ? block : buddy;
+        MemoryBlock* upper = (lower == block) ? buddy : block;
+        lower->size += upper->size;
+        lower->next = upper->next;
+        if(upper->next) upper->next->prev = lower;
+        pool.destroy(upper);
+
+        block = lower;
+        order++;
+    }
+
+    push_free(block, order);
+    return block;
+}
+
+MemoryBlock* BuddyAllocator::release(MemoryBlock* block){
+    // Carve into the largest aligned power-of-two pieces, lowest address first
+    while(true){
+        size_t piece = 1;
+        while(piece * 2 <= block->size && (block->start_address & (piece * 2 - 1)) == 0){
+            piece <<= 1;
+        }
+        if(piece == block->size) return release_aligned(block);
+
+        MemoryBlock* rest = split(block, piece);
+        release_aligned(block);
+        block = rest;
+    }
+}
+
+void BuddyAllocator::clear(){
+    for(int order = 0; order <= max_order; order++){
+        MemoryBlock* block = free_lists[order];
+        while(block){
+            MemoryBlock* next = block->next_free;
+            block->next_free = block->prev_free = nullptr;
+            block = next;
+        }
+        free_lists[order] = nullptr;
+    }
+    std::fill(free_bitmap.begin(), free_bitmap.end(), 0);
+    free_count = 0;
+}
+
+size_t BuddyAllocator::largest() const{
+    for(int order = max_order; order >= 0; order--){
+        if(free_lists[order]) return (size_t)1 << order;
+    }
+    return 0;
+}
@@ -0,0 +1,551 @@
+#include "../include/CacheHierarchy.hpp"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+
+CacheHierarchy::CacheHierarchy(const std::vector<CacheLevelConfig>& configs, CacheInclusion mode, unsigned long long dram_cycles,
+                               size_t core_count)
+    : inclusion(mode), dram_latency(dram_cycles), cores(core_count == 0 ? 1 : core_count) {
+    for(const CacheLevelConfig& config : configs){
+        Level level;
+        size_t copies = levels.empty() ? cores : 1;
+        for(size_t i = 0; i < copies; i++){
+            level.caches.push_back(make_cache(config.size, config.block_size, config.assoc, config.policy));
+            Prefetcher* prefetcher = make_prefetcher(config.prefetcher, config.prefetch_degree, config.prefetch_distance);
+            if(prefetcher) level.prefetchers.push_back(prefetcher);
+        }
+        level.arrivals.resize(level.prefetchers.size());
+        prefetching = prefetching || !level.prefetchers.empty();
+        level.config = config;
+        levels.push_back(level);
+    }
+    //A prefetch fill can push lines out of the levels it passes through too
+    if(prefetching){
+        for(Level& level : levels) level.displaced.resize(level.caches.size());
+    }
+}
+
+CacheHierarchy::~CacheHierarchy(){
+    for(Level& level : levels){
+        for(Cache* cache : level.caches) delete cache;
+        for(Prefetcher* prefetcher : level.prefetchers) delete prefetcher;
+    }
+}
+
+std::vector<CacheLevelConfig> CacheHierarchy::default_levels(){
+    //L1: 128B Size, 16B block, 2-way set associative. L2: 512B, 4-way
+    return { {128, 16, 2, 4, "fifo", true, "", 0, 0}, {512, 16, 4, 12, "fifo", true, "", 0, 0} };
+}
+
+bool CacheHierarchy::parse_level(const std::string& spec, CacheLevelConfig& config){
+    std::vector<std::string> fields;
+    std::stringstream ss(spec);
+    std::string field;
+    while(std::getline(ss, field, ':')) fields.push_back(field);
+    if(fields.size() < 4 || fields.size() > 7) return false;
+
+    try{
+        config.size = std::stoull(fields[0]);
+        config.block_size = std::stoull(fields[1]);
+        config.assoc = std::stoull(fields[2]);
+        config.latency = std::stoull(fields[3]);
+    } catch(...){
+        return false;
+    }
+    if(config.size == 0 || config.block_size == 0 || config.assoc == 0) return false;
+
+    config.policy = "fifo";
+    config.write_back = true;
+    config.prefetcher.clear();
+    config.prefetch_degree = config.prefetch_distance = 0;
+    for(size_t i = 4; i < fields.size(); i++){
+        if(fields[i] == "wb") config.write_back = true;
+        else if(fields[i] == "wt") config.write_back = false;
+        else if(Cache::is_policy(fields[i])) config.policy = fields[i];
+        else if(!parse_prefetcher(fields[i], config.prefetcher, config.prefetch_degree, config.prefetch_distance)) return false;
+    }
+    return true;
+}
+
+bool CacheHierarchy::parse_inclusion(const std::string& name, CacheInclusion& mode){
+    if(name == "inclusive") mode = CacheInclusion::Inclusive;
+    else if(name == "exclusive") mode = CacheInclusion::Exclusive;
+    else if(name == "non_inclusive") mode = CacheInclusion::NonInclusive;
+    else return false;
+    return true;
+}
+
+bool CacheHierarchy::parse_config(const std::string& text, std::vector<CacheLevelConfig>& levels, CacheInclusion& mode){
+    std::string spaced = text;
+    for(char& c : spaced) if(c == ',') c = ' ';
+    std::stringstream ss(spaced);
+    std::string token;
+
+    levels.clear();
+    mode = CacheInclusion::NonInclusive;
+    bool first = true;
+    while(ss >> token){
+        CacheLevelConfig config;
+        if(first && parse_inclusion(token, mode)){
+            first = false;
+            continue;
+        }
+        first = false;
+        if(!parse_level(token, config)) return false;
+        levels.push_back(config);
+    }
+    return !levels.empty();
+}
+
+bool CacheHierarchy::valid_config(const std::vector<CacheLevelConfig>& levels, CacheInclusion mode){
+    if(levels.empty()) return false;
+    for(const CacheLevelConfig& level : levels){
+        if(mode == CacheInclusion::Exclusive && !level.prefetcher.empty()) return false;
+    }
+    for(size_t i = 1; i < levels.size(); i++){
+        size_t upper = levels[i - 1].block_size;
+        size_t lower = levels[i].block_size;
+        if(mode == CacheInclusion::Inclusive && (lower < upper || lower % upper != 0)) return false;
+        if(mode == CacheInclusion::Exclusive && lower != upper) return false;
+    }
+    return true;
+}
+
+const char* CacheHierarchy::inclusion_name(CacheInclusion mode){
+    switch(mode){
+        case CacheInclusion::Inclusive: return "Inclusive";
+        case CacheInclusion::Exclusive: return "Exclusive";
+        default: return "Non-Inclusive";
+    }
+}
+
+// Whether a miss at this level brings the line in
+bool CacheHierarchy::allocates(size_t level, bool write) const{
+    if(inclusion == CacheInclusion::Exclusive) return level == 0;
+    if(!write || inclusion == CacheInclusion::Inclusive) return true;
+    return levels[level].config.write_back;
+}
+
+void CacheHierarchy::install(size_t level, size_t address, bool dirty, bool prefetched){
+    Level& current = levels[level];
+    if(prefetching) current.displaced[copy_at(level)].lines.erase(address / current.config.block_size);
+    CacheVictim victim = cache_at(level)->fill(address, dirty, prefetched);
+    if(!victim.valid) return;
+    if(victim.prefetched) unused_prefetch(level, copy_at(level), victim.address);
+    if(in_prefetch) displace(level, copy_at(level), victim.address);
+    evict(level, victim);
+}
+
+// A prefetched line leaves a copy without having been used
+void CacheHierarchy::unused_prefetch(size_t level, size_t copy, size_t address){
+    Level& current = levels[level];
+    current.unused_prefetches++;
+    auto& arrivals = current.arrivals[copy];
+    auto found = arrivals.find(address / current.config.block_size);
+    if(found == arrivals.end()) return;
+    if(found->second.from_dram) current.unused_dram_bytes += levels.back().config.block_size;
+    arrivals.erase(found);
+}
+
+// Every way a line is dropped other than eviction goes through here, so a prefetched
+// line nobody used is counted however it leaves
+bool CacheHierarchy::drop(size_t level, size_t copy, size_t address, bool& was_dirty){
+    Cache* cache = levels[level].caches[copy];
+    if(!levels[level].prefetchers.empty() && cache->claim_prefetched(address)) unused_prefetch(level, copy, address);
+    return cache->invalidate(address, was_dirty);
+}
+
+void CacheHierarchy::displace(size_t level, size_t copy, size_t address){
+    Level& current = levels[level];
+    Level::Displaced& out = current.displaced[copy];
+    size_t line = address / current.config.block_size;
+    size_t entry = out.entries++;
+    out.lines[line] = entry;
+    out.order.push_back({line, entry});
+    size_t capacity = current.config.size / current.config.block_size;
+    while(out.order.size() > capacity){
+        auto found = out.lines.find(out.order.front().first);
+        if(found != out.lines.end() && found->second == out.order.front().second) out.lines.erase(found);
+        out.order.pop_front();
+    }
+}
+
+bool CacheHierarchy::polluted(size_t level, size_t address){
+    Level& current = levels[level];
+    if(current.displaced[copy_at(level)].lines.erase(address / current.config.block_size) == 0) return false;
+    current.pollution_misses++;
+    return true;
+}
+
+void CacheHierarchy::evict(size_t level, const CacheVictim& victim){
+    Level& current = levels[level];
+    bool dirty = victim.dirty;
+
+    //Inclusive: the line may not outlive this copy in any level above.
+    //A dirty copy above carries the newest data, so it is written back with this one.
+    if(inclusion == CacheInclusion::Inclusive){
+        for(size_t upper = 0; upper < level; upper++){
+            size_t step = levels[upper].config.block_size;
+            if(step > current.config.block_size) step = current.config.block_size;
+            for(size_t copy = 0; copy < levels[upper].caches.size(); copy++){
+                for(size_t offset = 0; offset < current.config.block_size; offset += step){
+                    bool was_dirty = false;
+                    if(drop(upper, copy, victim.address + offset, was_dirty)){
+                        levels[upper].back_invalidations++;
+                        dirty = dirty || was_dirty;
+                        if(in_prefetch) displace(upper, copy, victim.address + offset);
+                    }
+                }
+            }
+        }
+    }
+
+    //Exclusive: victims move one level down, clean or dirty
+    if(inclusion == CacheInclusion::Exclusive && level + 1 < levels.size()){
+        Cache* lower = cache_at(level + 1);
+        if(lower->contains(victim.address)){
+            if(dirty) lower->set_dirty(victim.address);
+        } else {
+            install(level + 1, victim.address, dirty);
+        }
+        if(dirty) current.writebacks++;
+        return;
+    }
+
+    if(dirty){
+        current.writebacks++;
+        write_down(level + 1, victim.address, current.config.block_size);
+    }
+}
+
+// Carries written data from `level` down until a write-back level holding the line absorbs it.
+// Every write-through level holding it passes it on; if none absorbs it, `bytes` go to DRAM.
+void CacheHierarchy::write_down(size_t level, size_t address, size_t bytes){
+    for(; level < levels.size(); level++){
+        Level& current = levels[level];
+        if(current.config.write_back){
+            if(cache_at(level)->set_dirty(address)) return;
+        } else if(cache_at(level)->contains(address)){
+            current.write_throughs++;
+        }
+    }
+    dram_writes++;
+    dram_write_bytes += bytes;
+}
+
+// First demand use of a prefetched line, `at` cycles into the timeline
+unsigned long long CacheHierarchy::use_prefetch(size_t level, size_t address, unsigned long long at){
+    Level& current = levels[level];
+    current.useful_prefetches++;
+    auto& arrivals = current.arrivals[copy_at(level)];
+    auto found = arrivals.find(address / current.config.block_size);
+    if(found == arrivals.end()) return 0;
+    unsigned long long wait = (found->second.at > at) ? found->second.at - at : 0;
+    arrivals.erase(found);
+    if(wait > 0){
+        current.late_prefetches++;
+        current.late_cycles += wait;
+    }
+    return wait;
+}
+
+// Shows the access to the prefetcher of every level it reached, and fetches what they name
+void CacheHierarchy::run_prefetchers(size_t address, size_t looked_up, size_t hit, int used_level, unsigned long long at){
+    for(size_t i = 0; i < looked_up; i++){
+        Level& current = levels[i];
+        if(current.prefetchers.empty()) continue;
+        size_t block = current.config.block_size;
+        candidates.clear();
+        current.prefetchers[copy_at(i)]->observe(address / block, i < hit, (int)i == used_level, candidates);
+        for(size_t line : candidates) prefetch(i, line * block, at);
+    }
+}
+
+void CacheHierarchy::prefetch(size_t level, size_t address, unsigned long long at){
+    if(cache_at(level)->contains(address)) return;
+    if(level == 0){
+        for(size_t peer = 0; peer < cores; peer++){
+            if(peer != core && levels[0].caches[peer]->contains(address)) return;
+        }
+    }
+
+    //Fetched as a read miss would be
+    unsigned long long latency = 0;
+    size_t source = level + 1;
+    for(; source < levels.size(); source++){
+        latency += levels[source].config.latency;
+        if(cache_at(source)->contains(address)) break;
+    }
+    Level& current = levels[level];
+    if(source == levels.size()){
+        latency += dram_latency;
+        dram_reads++;
+        dram_read_bytes += levels.back().config.block_size;
+        current.prefetch_dram_bytes += levels.back().config.block_size;
+    }
+    in_prefetch = true;
+    for(size_t i = source; i-- > level + 1; ) install(i, address, false);
+    install(level, address, false, true);
+    in_prefetch = false;
+    current.prefetches++;
+    current.arrivals[copy_at(level)][address / current.config.block_size] = {at + latency, source == levels.size()};
+}
+
+CacheHierarchy::LineSharing& CacheHierarchy::note_access(size_t address){
+    size_t block = levels[0].config.block_size;
+    LineSharing& line = sharing[address / block];
+    if(line.words.empty()) line.words.assign(cores, 0);
+    line.words[core] |= (uint64_t)1 << ((address % block) / WORD_SIZE % 64);
+    return line;
+}
+
+bool CacheHierarchy::snoop(size_t address, bool write, bool& shared){
+    bool supplied = false;
+    shared = false;
+    LineSharing& line = note_access(address);
+    uint64_t written_word = (uint64_t)1 << ((address % levels[0].config.block_size) / WORD_SIZE % 64);
+
+    for(size_t peer = 0; peer < cores; peer++){
+        if(peer == core) continue;
+        Cache* copy = levels[0].caches[peer];
+        LineState state = copy->state_of(address);
+        if(state == LineState::Invalid) continue;
+
+        if(state == LineState::Modified){
+            if(write && !allocates(0, true)){
+                //Nobody takes the line over, so the owner's data goes below
+                levels[0].writebacks++;
+                write_down(1, address, levels[0].config.block_size);
+            } else {
+                supplied = true;
+                cache_to_cache++;
+                last_supplier = (int)peer;
+            }
+        }
+        if(write){
+            bool was_dirty;
+            drop(0, peer, address, was_dirty);
+            invalidations++;
+            line.invalidations++;
+            if((line.words[peer] & written_word) == 0){
+                false_sharing++;
+                line.false_sharing++;
+            }
+            line.words[peer] = 0;
+        } else {
+            //The owner keeps a Shared copy, so its dirty data goes below too
+            if(state == LineState::Modified){
+                levels[0].writebacks++;
+                write_down(1, address, levels[0].config.block_size);
+            }
+            copy->set_state(address, LineState::Shared);
+            shared = true;
+        }
+    }
+    return supplied;
+}
+
+unsigned long long CacheHierarchy::access(size_t address, bool write, size_t on_core){
+    unsigned long long cycles = 0;
+    core = (on_core < cores) ? on_core : on_core % cores;
+    last_supplier = -1;
+
+    // 1. Look the levels up in order until one hits. In multi-core mode an L1
+    //    miss (or a write to a Shared line) snoops the other cores first.
+    size_t hit = levels.size();
+    size_t looked_up = 0;
+    int used_prefetch = -1; // level whose prefetched line this access used first
+    bool shared = false;
+    for(size_t i = 0; i < levels.size(); i++){
+        cycles += levels[i].config.latency;
+        looked_up++;
+        if(cache_at(i)->lookup(address, false)){
+            hit = i;
+            if(!levels[i].prefetchers.empty() && cache_at(i)->claim_prefetched(address)){
+                used_prefetch = (int)i;
+                cycles += use_prefetch(i, address, now + cycles);
+            }
+            if(i == 0 && cores > 1){
+                if(write && cache_at(0)->state_of(address) == LineState::Shared){
+                    upgrades++;
+                    snoop(address, true, shared);
+                } else {
+                    note_access(address);
+                }
+            }
+            break;
+        }
+        if(i == 0 && cores > 1 && snoop(address, write, shared)){
+            hit = 1; // the peer's line is all that is needed, the shared levels are not looked up
+            break;
+        }
+    }
+
+    // 2. Bring the line up into the levels that allocate it. A miss on a line some
+    //    prefetch pushed out makes the DRAM read, if there is one, the prefetch's doing
+    bool needs_line = false;
+    bool pollution = false;
+    for(size_t i = 0; i < hit; i++){
+        needs_line = needs_line || allocates(i, write);
+        if(prefetching) pollution = polluted(i, address) || pollution;
+    }
+    last_level = (hit < levels.size() || needs_line) ? (int)hit : -1;
+
+    if(hit == levels.size() && needs_line){
+        cycles += dram_latency;
+        dram_reads++;
+        size_t lowest = 0;
+        for(size_t i = 0; i < levels.size(); i++) if(allocates(i, write)) lowest = i;
+        dram_read_bytes += levels[lowest].config.block_size;
+        if(pollution) pollution_dram_bytes += levels[lowest].config.block_size;
+    }
+
+    if(inclusion == CacheInclusion::Exclusive){
+        bool dirty = false;
+        if(hit > 0 && hit < levels.size()) cache_at(hit)->invalidate(address, dirty);
+        if(hit > 0) install(0, address, dirty);
+    } else {
+        //Bottom-up, so inclusion holds at every step
+        for(size_t i = hit; i-- > 0; ){
+            if(allocates(i, write)) install(i, address, false);
+        }
+    }
+    if(shared && hit > 0) cache_at(0)->set_state(address, LineState::Shared);
+
+    // 3. The store itself
+    if(write) write_down(0, address, WORD_SIZE);
+
+    // 4. Prefetches, issued once the access is done
+    if(prefetching) run_prefetchers(address, looked_up, hit, used_prefetch, now + cycles);
+    now += cycles;
+    return cycles;
+}
+
+bool CacheHierarchy::holds(size_t level, size_t address) const{
+    for(const Cache* copy : levels[level].caches){
+        if(copy->contains(address)) return true;
+    }
+    return false;
+}
+
+long long CacheHierarchy::level_hits(size_t level) const{
+    long long hits = 0;
+    for(const Cache* copy : levels[level].caches) hits += copy->get_hits();
+    return hits;
+}
+
+long long CacheHierarchy::level_misses(size_t level) const{
+    long long misses = 0;
+    for(const Cache* copy : levels[level].caches) misses += copy->get_misses();
+    return misses;
+}
+
+size_t CacheHierarchy::invalidate_range(size_t address, size_t bytes){
+    size_t dropped = 0;
+    if(bytes == 0) return dropped;
+    for(size_t level = 0; level < levels.size(); level++){
+        size_t block = levels[level].config.block_size;
+        for(size_t copy = 0; copy < levels[level].caches.size(); copy++){
+            for(size_t line = address / block * block; line < address + bytes; line += block){
+                bool was_dirty;
+                if(drop(level, copy, line, was_dirty)) dropped++;
+            }
+        }
+    }
+    size_t block = levels[0].config.block_size;
+    for(size_t line = address / block; line * block < address + bytes; line++) sharing.erase(line);
+    return dropped;
+}
+
+size_t CacheHierarchy::get_prefetch_dram_bytes() const{
+    size_t bytes = 0;
+    for(const Level& level : levels) bytes += level.prefetch_dram_bytes;
+    return bytes;
+}
+
+size_t CacheHierarchy::get_unused_prefetch_bytes() const{
+    size_t bytes = 0;
+    for(const Level& level : levels) bytes += level.unused_dram_bytes;
+    return bytes;
+}
+
+double CacheHierarchy::prefetch_accuracy(size_t issued, size_t useful){
+    return (issued == 0) ? 0.0 : (double)useful / issued * 100.0;
+}
+
+double CacheHierarchy::prefetch_coverage(size_t useful, long long misses){
+    long long would_miss = (long long)useful + misses;
+    return (would_miss == 0) ? 0.0 : (double)useful / would_miss * 100.0;
+}
+
+double CacheHierarchy::hit_ratio(size_t level) const{
+    long long hits = level_hits(level);
+    long long total = hits + level_misses(level);
+    return (total == 0) ? 0.0 : (double)hits / total * 100.0;
+}
+
+void CacheHierarchy::display_stats(){
+    std::cout << "Cache Levels: " << levels.size() << " | " << inclusion_name(inclusion) << "\n";
+    for(size_t i = 0; i < levels.size(); i++){
+        Level& level = levels[i];
+        for(size_t copy = 0; copy < level.caches.size(); copy++){
+            std::cout << "L" << (i + 1);
+            if(level.caches.size() > 1) std::cout << " (core " << copy << ")";
+            std::cout << " ";
+            level.caches[copy]->display_stats();
+        }
+        std::cout << "   " << (level.config.write_back ? "Write-Back" : "Write-Through")
+                  << " | Latency: " << level.config.latency
+                  << " | Write-backs: " << level.writebacks
+                  << " | Write-throughs: " << level.write_throughs;
+        if(inclusion == CacheInclusion::Inclusive) std::cout << " | Back-invalidations: " << level.back_invalidations;
+        std::cout << "\n";
+        if(level.prefetchers.empty()) continue;
+
+        const Prefetcher* model = level.prefetchers[0];
+        double late = (level.useful_prefetches == 0) ? 0.0 : (double)level.late_prefetches / level.useful_prefetches * 100.0;
+        std::cout << "   Prefetch: " << model->name() << " (degree " << model->get_degree()
+                  << ", distance " << model->get_distance() << ") | Issued: " << level.prefetches
+                  << " | Useful: " << level.useful_prefetches
+                  << " | Accuracy: " << prefetch_accuracy(level.prefetches, level.useful_prefetches)
+                  << "% | Coverage: " << prefetch_coverage(level.useful_prefetches, level_misses(i))
+                  << "% | Late: " << level.late_prefetches << " (" << late << "%, " << level.late_cycles
+                  << " cycles) | Unused: " << level.unused_prefetches << " | Pollution Misses: "
+                  << level.pollution_misses << "\n";
+    }
+    std::cout << "DRAM Reads: " << dram_reads << " (" << dram_read_bytes << " B) | DRAM Writes: "
+              << dram_writes << " (" << dram_write_bytes << " B)";
+    std::cout << "\n";
+    if(prefetching){
+        size_t issued = get_prefetch_dram_bytes();
+        size_t unused = get_unused_prefetch_bytes();
+        double share = (dram_read_bytes == 0) ? 0.0 : (double)issued / dram_read_bytes * 100.0;
+        std::cout << "   Prefetch-Issued Reads: " << issued << " B (" << share << "% of reads) | Extra Traffic: "
+                  << unused + pollution_dram_bytes << " B (" << unused << " B unused prefetches, "
+                  << pollution_dram_bytes << " B pollution misses)\n";
+    }
+    if(cores == 1) return;
+
+    std::cout << "Coherence (MESI, " << cores << " cores): Invalidations: " << invalidations
+              << " | Upgrades: " << upgrades << " | Cache-to-Cache: " << cache_to_cache
+              << " | False Sharing: " << false_sharing << "\n";
+
+    //Hot lines: the most invalidated L1 lines
+    std::vector<std::pair<size_t, const LineSharing*>> hot;
+    for(const auto& entry : sharing){
+        if(entry.second.invalidations > 0) hot.push_back({entry.first, &entry.second});
+    }
+    size_t shown = std::min<size_t>(hot.size(), 5);
+    std::partial_sort(hot.begin(), hot.begin() + shown, hot.end(),
+                      [](const std::pair<size_t, const LineSharing*>& a, const std::pair<size_t, const LineSharing*>& b){
+                          if(a.second->invalidations != b.second->invalidations)
+                              return a.second->invalidations > b.second->invalidations;
+                          return a.first < b.first;
+                      });
+    for(size_t i = 0; i < shown; i++){
+        std::cout << "  Hot line 0x" << std::hex << hot[i].first * levels[0].config.block_size << std::dec
+                  << ": " << hot[i].second->invalidations << " invalidations, "
+                  << hot[i].second->false_sharing << " false sharing\n";
+    }
+}
@@ -0,0 +1,133 @@
+#include "../include/FreeBlockIndex.hpp"
+
+FreeBlockIndex::~FreeBlockIndex(){
+    destroy(root);
+}
+
+unsigned FreeBlockIndex::next_priority(){
+    // xorshift32, good enough to keep the treap balanced
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+size_t FreeBlockIndex::max_of(Node* node){
+    return node ? node->max_size : 0;
+}
+
+void FreeBlockIndex::update(Node* node){
+    size_t best = node->size;
+    if(max_of(node->left) > best) best = max_of(node->left);
+    if(max_of(node->right) > best) best = max_of(node->right);
+    node->max_size = best;
+}
+
+void FreeBlockIndex::split(Node* node, size_t address, Node*& left, Node*& right){
+    if(!node){
+        left = right = nullptr;
+        return;
+    }
+    if(node->address < address){
+        split(node->right, address, node->right, right);
+        left = node;
+    } else {
+        split(node->left, address, left, node->left);
+        right = node;
+    }
+    update(node);
+}
+
+FreeBlockIndex::Node* FreeBlockIndex::merge(Node* left, Node* right){
+    if(!left) return right;
+    if(!right) return left;
+    if(left->priority > right->priority){
+        left->right = merge(left->right, right);
+        update(left);
+        return left;
+    }
+    right->left = merge(left, right->left);
+    update(right);
+    return right;
+}
+
+void FreeBlockIndex::destroy(Node* node){
+    if(!node) return;
+    destroy(node->left);
+    destroy(node->right);
+    delete node;
+}
+
+void FreeBlockIndex::insert(MemoryBlock* block){
+    Node* node = new Node{block->start_address, block->size, block->size, next_priority(), block, nullptr, nullptr};
+
+    Node* left;
+    Node* right;
+    split(root, block->start_address, left, right);
+    root = merge(merge(left, node), right);
+
+    by_size[{block->size, block->start_address}] = block;
+}
+
+void FreeBlockIndex::erase(MemoryBlock* block){
+    // Cut out exactly the node at this address
+    Node* left;
+    Node* middle;
+    Node* right;
+    split(root, block->start_address, left, middle);
+    split(middle, block->start_address + 1, middle, right);
+    destroy(middle);
+    root = merge(left, right);
+
+    by_size.erase({block->size, block->start_address});
+}
+
+void FreeBlockIndex::clear(){
+    destroy(root);
+    root = nullptr;
+    by_size.clear();
+}
+
+MemoryBlock* FreeBlockIndex::first_fit(size_t size) const{
+    Node* current = root;
+    while(current!=nullptr && current->max_size >= size){
+        if(max_of(current->left) >= size){
+            current = current->left;
+        }
+        else if(current->size >= size){
+            return current->block;
+        }
+        else{
+            current = current->right;
+        }
+    }
+    return nullptr;
+}
+
+MemoryBlock* FreeBlockIndex::first_from(size_t address) const{
+    Node* current = root;
+    MemoryBlock* found = nullptr;
+    while(current!=nullptr){
+        if(current->address >= address){
+            found = current->block;
+            current = current->left;
+        }
+        else{
+            current = current->right;
+        }
+    }
+    return found;
+}
+
+MemoryBlock* FreeBlockIndex::best_fit(size_t size) const{
+    auto it = by_size.lower_bound({size, 0});
+    if(it == by_size.end()) return nullptr;
+    return it->second;
+}
+
+MemoryBlock* FreeBlockIndex::worst_fit(size_t size) const{
+    if(by_size.empty()) return nullptr;
+    size_t largest = by_size.rbegin()->first.first;
+    if(largest < size) return nullptr;
+    return by_size.lower_bound({largest, 0})->second;
+}
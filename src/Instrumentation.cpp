@@ -0,0 +1,61 @@
+#include "../include/Instrumentation.hpp"
+#include <iomanip>
+
+static const char* PROBE_NAMES[] = {"allocate", "deallocate", "virtual_to_physical", "get_free_frame_or_evict", "cache_access",
+                                     "compact"};
+
+Instrumentation::Instrumentation() : start_ticks(ticks()), start_time(std::chrono::steady_clock::now()) {}
+
+bool Instrumentation::enabled(){
+#ifndef MEMSIM_NO_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* Instrumentation::probe_name(Probe probe){
+    return PROBE_NAMES[(int)probe];
+}
+
+double Instrumentation::ticks_per_ns() const{
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_time).count();
+    return (ns <= 0) ? 1.0 : (double)(ticks() - start_ticks) / ns;
+}
+
+double Instrumentation::mean_ns(Probe probe) const{
+    const ProbeStats& p = probes[(int)probe];
+    return (p.calls == 0) ? 0.0 : (double)p.total_ticks / p.calls / ticks_per_ns();
+}
+
+void Instrumentation::write_json(std::ostream& out) const{
+    out << "{\"enabled\": " << (enabled() ? "true" : "false");
+    if(!enabled()){
+        out << "}";
+        return;
+    }
+
+    double rate = ticks_per_ns();
+    out << std::fixed << std::setprecision(3) << ", \"ticks_per_ns\": " << rate << ", \"probes\": {";
+    for(int i = 0; i < (int)Probe::Count; i++){
+        const ProbeStats& p = probes[i];
+        double mean = (p.calls == 0) ? 0.0 : (double)p.total_ticks / p.calls;
+        out << (i ? ", " : "") << "\"" << PROBE_NAMES[i] << "\": {"
+            << "\"calls\": " << p.calls
+            << ", \"total_ns\": " << p.total_ticks / rate
+            << ", \"mean_ns\": " << mean / rate
+            << ", \"min_ns\": " << (p.calls ? p.min_ticks / rate : 0.0)
+            << ", \"max_ns\": " << p.max_ticks / rate
+            << ", \"histogram\": [";
+        //Only the buckets in use, each as its upper bound in ns and its count
+        bool first = true;
+        for(int b = 0; b < BUCKETS; b++){
+            if(p.histogram[b] == 0) continue;
+            out << (first ? "" : ", ") << "{\"below_ns\": " << (double)((uint64_t)1 << b) / rate
+                << ", \"count\": " << p.histogram[b] << "}";
+            first = false;
+        }
+        out << "]}";
+    }
+    out << "}}";
+}
@@ -1,408 +1,1390 @@
 #include "./../include/MemoryManager.hpp"
+#include "./../include/StatsSampler.hpp"
 #include <iomanip>
-#include <limits>
-#include <thread>
-#include <chrono>
+#include <utility>
+#include <algorithm>
+#include <cstring>
 
 //Constructor: Initializes the simulation with one giant FREE block
 MemoryManager::MemoryManager(size_t size) : total_size(size), current_strategy("First Fit") {
     // Physical Memory Setup
     physical_memory_size = size;
-    total_frames = physical_memory_size / page_size;
-    frame_table.assign(total_frames, -1); // All frames free (-1)
+    setup_frames();
+
+    page_policy_name = "fifo";
+    page_policy = make_replacement_policy(page_policy_name, total_frames,
+                                          [this](int frame){ return test_and_clear_referenced(frame); });
 
-    // Virtual Memory Manager: The 'head' list manages VIRTUAL space.
-    head = new MemoryBlock(0, 65536, true, -1);
+    // Virtual Memory Manager: the shared space's list manages VIRTUAL space.
+    shared_space = new AddressSpace(block_pool, SHARED_HEAP, SHARED_HEAP, page_size, false, strategy);
+    recount(shared_space);
 
-    //Cache: 128B Size, 16B block, 2-way set associative
-    l1_cache = new Cache(128, 16, 2);
-    l2_cache = new Cache(512, 16, 4);
+    //Cache: 128B 2-way L1 and 512B 4-way L2, 16B blocks
+    cache_levels = CacheHierarchy::default_levels();
+    caches = new CacheHierarchy(cache_levels, cache_inclusion, latency.dram);
+
+    //TLB: 16 entries, 4-way, LRU, ASID tagged
+    tlb = new TLB(16, 4, "lru", true);
 }
 
-//Destructor: Clean up the linked list to avoid memory leaks
+//Destructor: block_pool frees its chunks wholesale, so the spaces leave their list
+//nodes to it instead of handing them back one by one
 MemoryManager::~MemoryManager(){
-    MemoryBlock* current = head;
-    while(current!=nullptr){
-        MemoryBlock* next = current->next;
-        delete current;
-        current = next;
+    delete swap;
+    shared_space->abandon_nodes();
+    delete shared_space;
+    for(auto& pair : spaces){
+        pair.second->abandon_nodes();
+        delete pair.second;
     }
-    delete l1_cache;
-    delete l2_cache;
+    delete caches;
+    delete scheduler;
+    delete tlb;
+    delete page_policy;
+    delete profiler;
     for(auto& pair : process_page_tables){
         delete pair.second;
     }
     process_page_tables.clear();
 }
 
-int MemoryManager::get_free_frame_or_evict(int pid){
-    //1. Check for free frames
-    for(int i=0; i<(int)total_frames; i++){
-        if(frame_table[i] == -1){
-            frame_table[i] = pid;
-            active_frames_fifo.push_back(i);
-            return i;
+int MemoryManager::take_free_frame(){
+    for(size_t word = free_frame_hint; word < free_frame_bitmap.size(); word++){
+        if(free_frame_bitmap[word] != 0){
+            free_frame_hint = word;
+            int frame = (int)(word * 64 + __builtin_ctzll(free_frame_bitmap[word]));
+            free_frame_bitmap[word] &= free_frame_bitmap[word] - 1; // clear lowest set bit
+            free_frame_count--;
+            return frame;
         }
     }
+    free_frame_hint = free_frame_bitmap.size(); // RAM full, nothing to search until a frame returns
+    return -1;
+}
 
-    //2. If NO free frame -> Eviction (FIFO)
-    std::cout << "[DISK I/O] Physical Memory Full. Evicting victim page...\n";
-    std::this_thread::sleep_for(std::chrono::milliseconds(200)); //Simulate disk latency
+void MemoryManager::return_free_frame(int frame){
+    free_frame_bitmap[frame / 64] |= (uint64_t)1 << (frame % 64);
+    free_frame_count++;
+    if((size_t)frame / 64 < free_frame_hint) free_frame_hint = frame / 64;
+}
+
+//Clearing the bit also drops the TLB entry, so the next access walks the
+//page table again and sets it, as hardware would
+bool MemoryManager::test_and_clear_referenced(int frame){
+    int pid = frame_table[frame];
+    auto table = process_page_tables.find(pid);
+    if(pid == -1 || table == process_page_tables.end()) return false;
+
+    PageTableEntry* entry = table->second->lookup(frame_page[frame]);
+    if(entry == nullptr || !entry->referenced) return false;
+    entry->referenced = false;
+    tlb->invalidate(pid, frame_page[frame]);
+    return true;
+}
+
+int MemoryManager::get_free_frame_or_evict(int pid, size_t now){
+    MEMSIM_PROBE(instrumentation, Probe::FrameAlloc);
+
+    //1. Check for free frames
+    int free_frame = take_free_frame();
+    if(free_frame != -1){
+        frame_table[free_frame] = pid;
+        process_frames[pid].insert(free_frame);
+        page_policy->on_load(free_frame, now);
+        return free_frame;
+    }
 
-    //A. Pick victim framefrom the front of FIFO queue
-    int victim_frame = active_frames_fifo.front();
-    active_frames_fifo.pop_front();
+    //2. If NO free frame -> Eviction (chosen by the replacement policy)
+    //Disk latency is charged to the virtual clock instead of sleeping.
+    //A. Pick victim frame. Pinned frames are set aside and tracked again afterwards;
+    //   one is only taken if nothing else is resident
+    int victim_frame = page_policy->pick_victim(now);
+    std::vector<int> skipped;
+    while(victim_frame != -1 && pinned_frames[victim_frame]){
+        skipped.push_back(victim_frame);
+        victim_frame = page_policy->pick_victim(now);
+    }
+    for(int frame : skipped) page_policy->on_skip(frame, now);
+    if(victim_frame == -1) victim_frame = page_policy->pick_victim(now);
+    if(victim_frame == -1) return -1; // RAM smaller than a page: no frame at all
+    page_evictions++;
+    if(verbose) std::cout << "[DISK I/O] Physical Memory Full. Evicting victim page...\n";
 
-    //B. Find out who owned this frame
+    //B. Find out who owned this frame, and which of its pages lives there (reverse map)
     int victim_pid = frame_table[victim_frame];
+    size_t victim_page = frame_page[victim_frame];
 
     //C. Update victim's page table
     //This is basically telling the old process that its address "X" is no longer in RAM
-    if(victim_pid!=-1 && process_page_tables.find(victim_pid)!=process_page_tables.end()){
-        process_page_tables[victim_pid]->invalidate_frame(victim_frame);
-        std::cout << " -> Evicted PID " << victim_pid << " from Frame " << victim_frame << "\n";
+    auto victim_table = process_page_tables.find(victim_pid);
+    if(victim_pid!=-1 && victim_table!=process_page_tables.end()){
+        //Only a page written since it was loaded has to go back to disk
+        PageTableEntry* victim_entry = victim_table->second->lookup(victim_page);
+        if(victim_entry != nullptr && victim_entry->dirty){
+            page_writebacks++;
+            simulated_cycles += latency.page_writeback;
+            if(verbose) std::cout << "[DISK I/O] Writing dirty page " << victim_page << " back to disk\n";
+        }
+        if(swap) page_out(victim_pid, victim_page, victim_frame, victim_entry != nullptr && victim_entry->dirty);
+        victim_table->second->invalidate(victim_page);
+        if(verbose){
+            std::cout << "[PAGE TABLE] Page " << victim_page << " is now INVALID (evicted from frame " << victim_frame << ")\n";
+            std::cout << " -> Evicted PID " << victim_pid << " from Frame " << victim_frame << "\n";
+        }
+        //The stale translation must not survive in the TLB
+        tlb->invalidate(victim_pid, victim_page);
     }
+    process_frames[victim_pid].erase(victim_frame);
 
     //D. Assign frame to new process 
     frame_table[victim_frame] = pid;
-    active_frames_fifo.push_back(victim_frame);
+    process_frames[pid].insert(victim_frame);
+    page_policy->on_load(victim_frame, now);
 
     return victim_frame;
 }
 
-size_t MemoryManager::virtual_to_physical(int pid, size_t virtual_addr){
+size_t MemoryManager::virtual_to_physical(int pid, size_t virtual_addr, bool write){
+    MEMSIM_PROBE(instrumentation, Probe::Translate);
     // 1. If process doesn't have a page table, create one
-    if(process_page_tables.find(pid) == process_page_tables.end()){
-        process_page_tables[pid] = new PageTable(page_size);
+    PageTable*& table = process_page_tables[pid];
+    if(table == nullptr){
+        table = new PageTable(page_size, page_table_levels, page_table_bits);
     }
 
     size_t page_num = virtual_addr / page_size;
     size_t offset = virtual_addr % page_size;
 
-    int frame_num = process_page_tables[pid]->translate(page_num);
+    if(!table->covers(page_num)){
+        segmentation_faults++;
+        if(verbose) std::cout << "[SEGFAULT] Page " << page_num << " is beyond the page table's reach\n";
+        return INVALID_ADDRESS;
+    }
+
+    // 2. TLB first, the page table only on a TLB miss
+    int frame_num = tlb->lookup(pid, page_num);
+    if(frame_num != -1){
+        if(verbose) std::cout << " -> TLB Hit\n";
+        page_policy->on_access(frame_num, memory_accesses - 1);
+        if(write) table->lookup(page_num)->dirty = true;
+        return (frame_num * page_size) + offset;
+    }
+    frame_num = table->translate(page_num);
+    page_walks++;
+    page_walk_levels += table->get_last_depth();
+    simulated_cycles += latency.page_walk * table->get_last_depth();
+    if(verbose) std::cout << " -> TLB Miss, walking page table\n";
 
     if(frame_num==-1){
         // PAGE FAULT HANDLING
-        std::cout << "[PAGE FAULT] Process " << pid << " accessed Page " << page_num << "\n";
+        if(verbose) std::cout << "[PAGE FAULT] Process " << pid << " accessed Page " << page_num << "\n";
+        page_faults++;
+        simulated_cycles += latency.page_fault;
 
-        frame_num = get_free_frame_or_evict(pid);
+        frame_num = get_free_frame_or_evict(pid, memory_accesses - 1);
+        if(frame_num == -1){
+            if(verbose) std::cout << "[PAGE FAULT] No frame to load the page into\n";
+            return INVALID_ADDRESS;
+        }
 
-        //Update Page Table
-        process_page_tables[pid]->map(page_num, frame_num);
-        std::cout << "[PAGE FAULT HANDLED] Mapped V-Page " << page_num << " -> P-Frame " << frame_num << "\n";
+        //Update Page Table and the reverse map
+        table->map(page_num, frame_num);
+        frame_page[frame_num] = page_num;
+        if(swap) page_in(pid, page_num, frame_num);
+        if(verbose) std::cout << "[PAGE FAULT HANDLED] Mapped V-Page " << page_num << " -> P-Frame " << frame_num << "\n";
+    }
+    else{
+        page_policy->on_access(frame_num, memory_accesses - 1);
     }
-     return (frame_num * page_size) + offset;
+    if(write) table->lookup(page_num)->dirty = true;
+    tlb->insert(pid, page_num, frame_num);
+    return (frame_num * page_size) + offset;
 }
 
-void MemoryManager::access_memory(size_t virtual_addr, int pid){
-    std::cout << "\n[CPU Request] Process " << pid << " requesting Virtual Address 0x"
-              << std::hex << virtual_addr << std::dec << "...\n";
+void MemoryManager::access_memory(size_t virtual_addr, int pid, bool write){
+    if(verbose){
+        std::cout << "\n[CPU Request] Process " << pid << (write ? " writing" : " requesting") << " Virtual Address 0x"
+                  << std::hex << virtual_addr << std::dec << "...\n";
+    }
+
+    //Threads translate in the address space of their process
+    int space = owner_of(pid);
+    AddressSpace* mapped = space_of(space);
+    note_operation(mapped);
+    memory_accesses++;
+
+    //Blocks moved by compaction are still reached through their old addresses
+    if(!relocations.empty()) virtual_addr = relocate(space, virtual_addr);
+
+    //A private space only backs its regions
+    if(private_spaces && (mapped == nullptr || mapped->find(virtual_addr) == nullptr)){
+        segmentation_faults++;
+        if(verbose) std::cout << "[SEGFAULT] Address 0x" << std::hex << virtual_addr << std::dec << " is not mapped in PID " << space << "'s address space\n";
+        return;
+    }
 
     //Step 1: Translate Virtual ->physical (handles page faults)
-    size_t physical_addr = virtual_to_physical(pid, virtual_addr);
+    size_t physical_addr = virtual_to_physical(space, virtual_addr, write);
+    if(physical_addr == INVALID_ADDRESS) return;
+
+    //With real frames, a write stores a byte that depends on who wrote where and when
+    if(swap && write) frame_data[physical_addr] = (uint8_t)(virtual_addr ^ (virtual_addr >> 8) ^ space ^ memory_accesses);
 
-    std::cout << " -> Physical Address: 0x" << std::hex << physical_addr << std::dec << "\n";
+    if(profiler) profiler->record(physical_addr, space, virtual_addr / page_size);
+
+    if(verbose) std::cout << " -> Physical Address: 0x" << std::hex << physical_addr << std::dec << "\n";
 
     //Step 2: Access caches using physical address 
-    if(l1_cache->access(physical_addr)){
-        std::cout << " -> L1 Cache Hit!\n";
+    //Each level that is looked up adds its latency to the virtual clock
+    size_t core = scheduler ? scheduler->core_for(pid) : 0;
+    {
+        MEMSIM_PROBE(instrumentation, Probe::CacheAccess);
+        simulated_cycles += caches->access(physical_addr, write, core);
     }
-    else if(l2_cache->access(physical_addr)){
-        std::cout << " -> L1 miss, L2 Cache Hit!\n";
+    if(!verbose) return;
+
+    int level = caches->get_last_level();
+    if(scheduler) std::cout << " -> Running on core " << core << "\n";
+    if(caches->get_last_supplier() != -1){
+        std::cout << " -> L1 miss, line supplied by core " << caches->get_last_supplier() << "'s L1\n";
+        return;
     }
-    else{
-        std::cout << " -> L1 miss, L2 miss. Fetching from Main Memory...\n";
+    if(level == -1){
+        std::cout << " -> Cache miss, write sent to Main Memory\n";
+        return;
     }
+    std::cout << " -> ";
+    for(int i = 0; i < level; i++) std::cout << "L" << (i + 1) << " miss, ";
+    if(level < (int)caches->level_count()) std::cout << "L" << (level + 1) << " Cache Hit!\n";
+    else std::cout << "Fetching from Main Memory...\n";
+}
+
+//The access leaves the page resident, so its frame is read straight from the page table
+int MemoryManager::peek(size_t virtual_addr, int pid){
+    if(!swap) return -1;
+    access_memory(virtual_addr, pid);
+    int space = owner_of(pid);
+    if(!relocations.empty()) virtual_addr = relocate(space, virtual_addr);
+    auto table = process_page_tables.find(space);
+    if(table == process_page_tables.end()) return -1;
+    PageTableEntry* entry = table->second->lookup(virtual_addr / page_size);
+    if(entry == nullptr || !entry->valid) return -1;
+    return frame_data[(size_t)entry->frame_number * page_size + virtual_addr % page_size];
+}
+
+void MemoryManager::set_verbose(bool enabled){
+    verbose = enabled;
 }
 
-void MemoryManager::set_strategy(std::string strategy){
-    current_strategy = strategy;
+void MemoryManager::set_latency(const LatencyConfig& config){
+    latency = config;
+    caches->set_dram_latency(latency.dram);
+}
+
+bool MemoryManager::set_page_policy(const std::string& name, size_t ws_window){
+    ReplacementPolicy* policy = make_replacement_policy(name, total_frames,
+                                                        [this](int frame){ return test_and_clear_referenced(frame); },
+                                                        ws_window);
+    if(policy == nullptr) return false;
+    delete page_policy;
+    page_policy = policy;
+    page_policy_name = name;
+    if(!lookahead.empty()) page_policy->set_lookahead(&lookahead);
+
+    //Frames already resident are handed to the new policy in frame order
+    size_t now = (memory_accesses == 0) ? 0 : memory_accesses - 1;
+    for(size_t i = 0; i < total_frames; i++){
+        if(frame_table[i] != -1) page_policy->on_load((int)i, now);
+    }
+    return true;
 }
 
+void MemoryManager::set_lookahead(std::vector<size_t> next_use){
+    lookahead = std::move(next_use);
+    page_policy->set_lookahead(&lookahead);
+}
+
+void MemoryManager::setup_frames(){
+    total_frames = physical_memory_size / page_size;
+    frame_table.assign(total_frames, -1); // All frames free (-1)
+    frame_page.assign(total_frames, 0);
+    pinned_frames.assign(total_frames, 0);
+    free_frame_bitmap.assign((total_frames + 63) / 64, 0);
+    free_frame_hint = 0;
+    free_frame_count = 0;
+    for(size_t i = 0; i < total_frames; i++) return_free_frame((int)i);
+    if(swap) frame_data.assign(total_frames * page_size, 0);
+}
+
+bool MemoryManager::set_page_size(size_t bytes){
+    if(!process_page_tables.empty() || !spaces.empty()) return false;
+    if(bytes < 16 || (bytes & (bytes - 1)) != 0 || bytes > physical_memory_size) return false;
+    page_size = bytes;
+    //Slots are one page each, so the file starts over. If it cannot be recreated the
+    //device is dropped, as set_swap("") does, rather than kept with no file behind it
+    if(swap && !swap->open(swap->get_path(), page_size)){
+        if(verbose) std::cout << "Error: Could not recreate swap file " << swap->get_path() << ", swap is off.\n";
+        delete swap;
+        swap = nullptr;
+        frame_data.clear();
+    }
+    setup_frames();
+    if(profiler) restart_profiler();
+    return set_page_policy(page_policy_name); // the policy is sized by the frame count
+}
+
+bool MemoryManager::set_swap(const std::string& path){
+    if(!process_page_tables.empty()) return false;
+    if(path.empty()){
+        delete swap;
+        swap = nullptr;
+        frame_data.clear();
+        return true;
+    }
+    SwapDevice* device = new SwapDevice();
+    if(!device->open(path, page_size)){
+        delete device;
+        return false;
+    }
+    delete swap;
+    swap = device;
+    frame_data.assign(total_frames * page_size, 0);
+    return true;
+}
+
+//FNV-1a over the frame's bytes
+uint64_t MemoryManager::page_checksum(int frame) const{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const uint8_t* data = &frame_data[(size_t)frame * page_size];
+    for(size_t i = 0; i < page_size; i++) hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    return hash;
+}
+
+//Only a dirty page is written, into the slot of its copy if it has one
+void MemoryManager::page_out(int pid, size_t page, int frame, bool dirty){
+    if(!dirty){
+        clean_evictions++;
+        return;
+    }
+    std::unordered_map<size_t, SwapCopy>& copies = swap_copies[pid];
+    auto found = copies.find(page);
+    if(found == copies.end()) found = copies.emplace(page, SwapCopy{swap->allocate_slot(), 0}).first;
+    found->second.checksum = page_checksum(frame);
+    swap->write(found->second.slot, &frame_data[(size_t)frame * page_size]);
+    swap_outs++;
+}
+
+//The copy stays in its slot: while the page is clean, evicting it again costs no write
+void MemoryManager::page_in(int pid, size_t page, int frame){
+    uint8_t* data = &frame_data[(size_t)frame * page_size];
+    auto process = swap_copies.find(pid);
+    const SwapCopy* copy = nullptr;
+    if(process != swap_copies.end()){
+        auto found = process->second.find(page);
+        if(found != process->second.end()) copy = &found->second;
+    }
+    if(copy == nullptr){
+        std::fill(data, data + page_size, 0);
+        return;
+    }
+    swap_ins++;
+    if(!swap->read(copy->slot, data) || page_checksum(frame) != copy->checksum){
+        integrity_errors++;
+        if(verbose) std::cout << "[SWAP] Page " << page << " of PID " << pid << " came back corrupted\n";
+    }
+}
+
+bool MemoryManager::has_swap_copy(int pid, size_t page) const{
+    auto process = swap_copies.find(pid);
+    return process != swap_copies.end() && process->second.count(page);
+}
+
+void MemoryManager::drop_swap_copy(int pid, size_t page){
+    auto process = swap_copies.find(pid);
+    if(process == swap_copies.end()) return;
+    auto found = process->second.find(page);
+    if(found == process->second.end()) return;
+    swap->free_slot(found->second.slot);
+    process->second.erase(found);
+}
+
+void MemoryManager::drop_swap_copies(int pid){
+    auto process = swap_copies.find(pid);
+    if(process == swap_copies.end()) return;
+    for(auto& pair : process->second) swap->free_slot(pair.second.slot);
+    swap_copies.erase(process);
+}
+
+bool MemoryManager::configure_page_table(int levels, int bits_per_level){
+    if(!process_page_tables.empty() || !spaces.empty()) return false;
+    if(levels < 1 || bits_per_level < 1 || bits_per_level > PageTable::MAX_BITS_PER_LEVEL) return false;
+    if(levels * bits_per_level > 64) return false;
+    page_table_levels = levels;
+    page_table_bits = bits_per_level;
+    return true;
+}
+
+bool MemoryManager::configure_tlb(size_t entries, size_t assoc, const std::string& policy, bool asid){
+    if(!TLB::valid_config(entries, assoc, policy)) return false;
+    delete tlb;
+    tlb = new TLB(entries, assoc, policy, asid);
+    return true;
+}
+
+bool MemoryManager::set_cache_policy(int level, const std::string& policy){
+    if(!Cache::is_policy(policy) || level < 1 || level > (int)cache_levels.size()) return false;
+    std::vector<CacheLevelConfig> levels = cache_levels;
+    levels[level - 1].policy = policy;
+    return configure_caches(levels, cache_inclusion);
+}
+
+bool MemoryManager::configure_caches(const std::vector<CacheLevelConfig>& levels, CacheInclusion inclusion){
+    size_t cores = scheduler ? scheduler->get_cores() : 1;
+    if(!CacheHierarchy::valid_config(levels, inclusion)) return false;
+    if(cores > 1 && inclusion == CacheInclusion::Exclusive) return false;
+    cache_levels = levels;
+    cache_inclusion = inclusion;
+    delete caches;
+    caches = new CacheHierarchy(cache_levels, cache_inclusion, latency.dram, cores);
+    if(profiler) restart_profiler();
+    return true;
+}
+
+void MemoryManager::restart_profiler(){
+    std::vector<size_t> block_sizes;
+    for(const CacheLevelConfig& level : cache_levels) block_sizes.push_back(level.block_size);
+    delete profiler;
+    profiler = new ReuseProfiler(block_sizes, page_size);
+}
+
+void MemoryManager::set_profiling(bool enabled){
+    if(enabled){
+        restart_profiler();
+    } else {
+        delete profiler;
+        profiler = nullptr;
+    }
+}
+
+void MemoryManager::display_profile(){
+    if(!profiler){
+        std::cout << "Reuse profiling is off (use: profile on)\n";
+        return;
+    }
+    std::cout << "\n=========== REUSE PROFILE =============\n";
+    profiler->display();
+
+    //The configured sizes, read off the curves (fully associative LRU)
+    std::cout << "Predicted at the configured sizes:\n";
+    for(size_t i = 0; i < cache_levels.size(); i++){
+        size_t curve = profiler->curve_of_block(cache_levels[i].block_size);
+        size_t lines = cache_levels[i].size / cache_levels[i].block_size;
+        std::cout << "  L" << (i + 1) << " (" << lines << " lines): Miss Ratio "
+                  << std::fixed << std::setprecision(2)
+                  << profiler->distances(curve).miss_ratio(lines) * 100.0 << "%\n";
+    }
+    double fault_ratio = (memory_accesses == 0) ? 0.0 : (double)page_faults / memory_accesses * 100.0;
+    std::cout << "  RAM (" << total_frames << " frames): Miss Ratio "
+              << profiler->distances(profiler->page_curve()).miss_ratio(total_frames) * 100.0
+              << "% (simulated page faults: " << fault_ratio << "% with " << page_policy->name() << ")\n";
+    std::cout << "=======================================\n";
+}
+
+bool MemoryManager::write_profile(const std::string& path) const{
+    return profiler && profiler->write_csv(path);
+}
+
+bool MemoryManager::add_thread(int tid, int pid){
+    if(tid == pid || thread_owner.count(pid)) return false;
+    //A private space cannot be handed over: a tid that already has one stays a process
+    if(private_spaces && (process_blocks.count(tid) || spaces.count(tid))) return false;
+    thread_owner[tid] = pid;
+    return true;
+}
+
+bool MemoryManager::set_cores(size_t cores, const std::string& policy, size_t quantum){
+    if(cores == 0 || !Scheduler::is_policy(policy)) return false;
+    if(cores > 1 && cache_inclusion == CacheInclusion::Exclusive) return false;
+    delete scheduler;
+    scheduler = (cores > 1) ? new Scheduler(cores, policy, quantum) : nullptr;
+    delete caches;
+    caches = new CacheHierarchy(cache_levels, cache_inclusion, latency.dram, cores);
+    return true;
+}
+
+void MemoryManager::set_strategy(std::string name){
+    AllocStrategy next;
+    if(name == "First Fit") next = AllocStrategy::FirstFit;
+    else if(name == "Best Fit") next = AllocStrategy::BestFit;
+    else if(name == "Worst Fit") next = AllocStrategy::WorstFit;
+    else if(name == "Buddy") next = AllocStrategy::Buddy;
+    else if(name == "Slab") next = AllocStrategy::Slab;
+    else return;
+
+    current_strategy = name;
+    strategy = next;
+    shared_space->set_strategy(next);
+    if(!private_spaces) recount(shared_space);
+    for(auto& pair : spaces){
+        pair.second->set_strategy(next);
+        recount(pair.second);
+    }
+}
+
+bool MemoryManager::set_private_spaces(bool enabled){
+    if(total_allocs > 0 || memory_accesses > 0) return false;
+    private_spaces = enabled;
+    //The totals count the spaces in use: the shared one, or the private ones as they are created
+    if(enabled) uncount(shared_space);
+    else recount(shared_space);
+    return true;
+}
+
+int MemoryManager::owner_of(int pid) const{
+    auto owner = thread_owner.find(pid);
+    return (owner == thread_owner.end()) ? pid : owner->second;
+}
+
+AddressSpace* MemoryManager::space_of(int pid, bool create){
+    if(!private_spaces) return shared_space;
+    int owner = owner_of(pid);
+    auto found = spaces.find(owner);
+    if(found != spaces.end()) return found->second;
+    if(!create) return nullptr;
+    AddressSpace* space = new AddressSpace(block_pool, PRIVATE_HEAP, address_top(), page_size, true, strategy);
+    spaces[owner] = space;
+    recount(space);
+    return space;
+}
+
+size_t MemoryManager::address_top() const{
+    const size_t limit = (size_t)1 << 47; // 47-bit user space, as on x86-64
+    int bits = page_table_levels * page_table_bits + __builtin_ctzll(page_size);
+    return (bits >= 47) ? limit : (size_t)1 << bits;
+}
+
+//The space's blocks, Mappings and slab objects go with it (threads' included)
+void MemoryManager::delete_space(int owner){
+    auto found = spaces.find(owner);
+    if(found == spaces.end()) return;
+    AddressSpace* space = found->second;
+    uncount(space);
+    std::vector<int> pids(1, owner);
+    for(auto& pair : thread_owner){
+        if(pair.second == owner) pids.push_back(pair.first);
+    }
+    for(int pid : pids){
+        if(pid != owner) relocations.erase(pid);
+        auto owned = process_blocks.find(pid);
+        if(owned == process_blocks.end()) continue;
+        for(auto& block : owned->second){
+            //A Mapping's node is not on the list
+            if(space->find(block.first)->kind == RegionKind::Mapping) block_pool.destroy(block.second);
+        }
+        if(pid != owner) process_blocks.erase(owned);
+    }
+    delete space;
+    spaces.erase(found);
+}
+
+//Applies what changed in the space since it was last counted
+void MemoryManager::recount(AddressSpace* space){
+    AddressSpace::Footprint& then = space->counted;
+    size_t largest = space->largest_free();
+    if(then.heap_size == 0 || largest != then.largest_free){
+        if(then.heap_size != 0) largest_free_blocks.erase(largest_free_blocks.find(then.largest_free));
+        largest_free_blocks.insert(largest);
+        largest_free_total += largest - then.largest_free;
+        then.largest_free = largest;
+    }
+    heap_size_total += space->heap_size - then.heap_size;
+    heap_used_total += space->heap_used - then.heap_used;
+    mapped_total += space->mapped_bytes - then.mapped_bytes;
+    size_t mappings = space->get_regions().size() - 1;
+    mapping_total += mappings - then.mappings;
+    size_t free_blocks = space->free_count();
+    free_block_total += free_blocks - then.free_blocks;
+    then.heap_size = space->heap_size;
+    then.heap_used = space->heap_used;
+    then.mapped_bytes = space->mapped_bytes;
+    then.mappings = mappings;
+    then.free_blocks = free_blocks;
+}
+
+//Takes the space's counted share back out of the totals
+void MemoryManager::uncount(AddressSpace* space){
+    AddressSpace::Footprint& then = space->counted;
+    if(then.heap_size == 0) return; // not counted
+    heap_size_total -= then.heap_size;
+    heap_used_total -= then.heap_used;
+    mapped_total -= then.mapped_bytes;
+    mapping_total -= then.mappings;
+    free_block_total -= then.free_blocks;
+    largest_free_total -= then.largest_free;
+    largest_free_blocks.erase(largest_free_blocks.find(then.largest_free));
+    then = AddressSpace::Footprint();
+}
+
+struct MemoryManager::Recount{
+    MemoryManager& manager;
+    AddressSpace* space; // nullptr once it is gone
+    ~Recount(){ if(space) manager.recount(space); }
+};
+
 size_t MemoryManager::next_power_of_two(size_t n){
     size_t val = 1;
     while(val<n) val<<=1;
     return val;
 }
 
+MemoryBlock* MemoryManager::take_block(AddressSpace* space, size_t size){
+    MemoryBlock* block = space->take_block(size);
+    if(block == nullptr && space->grow(size)) block = space->take_block(size);
+    return block;
+}
+
 //the allocation logic
 long long MemoryManager::allocate(size_t request_size, int process_id){
+    MEMSIM_PROBE(instrumentation, Probe::Allocate);
+    AddressSpace* space = space_of(process_id, true);
+    note_operation(space);
+    Recount recount_after{*this, space};
     total_allocs++;
-    MemoryBlock* selected_block = nullptr;
-    
-    if(current_strategy == "First Fit"){
-        MemoryBlock* current = head;
-        while(current!=nullptr){
-            if(current->is_free && current->size>=request_size){
-                selected_block = current;
-                break;
-            }
-            current = current->next;
-        }
-    }
-    else if(current_strategy == "Best Fit"){
-        MemoryBlock* current = head;
-        size_t smallest_so_far = std::numeric_limits<size_t>::max();
-        while(current!=nullptr){
-            if(current->is_free && current->size>=request_size){
-                if(current->size < smallest_so_far){
-                    smallest_so_far = current -> size;
-                    selected_block = current;
-                }
-            }
-            current = current->next;
-        }
+
+    if(request_size == 0){
+        failed_allocs++;
+        return -1;
     }
-    else if(current_strategy == "Worst Fit"){
-        MemoryBlock* current = head;
-        size_t largest_so_far = 0;
-        while(current!=nullptr){
-            if(current->is_free && current->size>=request_size){
-                if(current->size>largest_so_far){
-                    largest_so_far = current->size;
-                    selected_block = current;
-                }
-            }
-            current = current->next;
+
+    //Large requests in a private space are mapped on their own, like mmap
+    if(private_spaces && request_size > MMAP_THRESHOLD){
+        size_t start = space->map(request_size);
+        if(start == AddressSpace::INVALID){
+            failed_allocs++;
+            return -1;
         }
+        MemoryBlock* mapping = block_pool.create(start, space->find(start)->size, false, process_id);
+        internal_fragmentation += mapping->size - request_size;
+        process_blocks[process_id][start] = mapping;
+        successful_allocs++;
+        return (long long)start;
     }
-    else if(current_strategy == "Buddy"){
-        size_t target_size = next_power_of_two(request_size);
-        MemoryBlock* current = head;
-        MemoryBlock* best_buddy = nullptr;
-
-        // 1. Finds the smallest block that is >= target_size
-        while(current!=nullptr){
-            if(current->is_free && current->size >= target_size){
-                if(!best_buddy || current->size < best_buddy->size){
-                    best_buddy = current;
-                }
-            }
-            current = current->next;
-        }
-        if(best_buddy){
-            // 2. Split the block until it is the perfect power-of-two size
-            while(best_buddy->size > target_size){
-                size_t new_size = best_buddy->size / 2;
-
-                //Create the buddy block
-                MemoryBlock* buddy = new MemoryBlock(
-                    best_buddy->start_address + new_size,
-                    new_size,
-                    true, -1
-                );
-
-                // Insert into the linked list
-                buddy->next = best_buddy->next;
-                buddy->prev = best_buddy;
-                if(best_buddy->next) best_buddy->next->prev = buddy;
-                best_buddy->next = buddy;
-
-                best_buddy->size = new_size;
-                // best_buddy remians the one we are looking for further splitting
-            }
 
-            selected_block = best_buddy;
+    //Small requests are rounded to a size class and served from a slab
+    if(strategy == AllocStrategy::Slab && SlabAllocator::is_small(request_size)){
+        if(space->slabs == nullptr){
+            space->slabs = new SlabAllocator(
+                [this, space](size_t span_size){
+                    MemoryBlock* span = take_block(space, span_size);
+                    if(span) span->process_id = SLAB_OWNER;
+                    return span;
+                },
+                [space](MemoryBlock* span){ space->release_block(span); }, slab_stats);
+        }
+        long long address = space->slabs->allocate(process_id, request_size);
+        if(address < 0){
+            failed_allocs++;
+            return -1;
         }
+        internal_fragmentation += SlabAllocator::class_size(SlabAllocator::class_of(request_size)) - request_size;
+        if(!relocations.empty()) retire_relocations(process_id, (size_t)address, request_size);
+        successful_allocs++;
+        return address;
     }
 
-    //Now after we find a block, using the split logic to split the memory to use only the required amount of memory
+    MemoryBlock* selected_block = take_block(space, request_size);
+    if(selected_block == nullptr && space->slabs && space->slabs->scavenge() > 0){
+        //Slabs emptied out of the PID caches may have left a large enough gap
+        selected_block = take_block(space, request_size);
+    }
     if(selected_block){
-        if(current_strategy == "Buddy"){
-            size_t actual_size = selected_block->size;
-            if(actual_size > request_size){
-                internal_fragmentation += (actual_size - request_size);
-            }
-        }
-        if(current_strategy!="Buddy" && selected_block->size > request_size){
-            MemoryBlock* new_free_block = new MemoryBlock(
-                selected_block->start_address+request_size,
-                selected_block->size-request_size, 
-                true, -1
-            );
-            new_free_block->next = selected_block->next;
-            new_free_block->prev = selected_block;
-            if(selected_block->next) selected_block->next->prev = new_free_block;
-            selected_block->next = new_free_block;
-            selected_block->size = request_size;
+        if(selected_block->size > request_size){
+            internal_fragmentation += (selected_block->size - request_size);
         }
-
-        selected_block->is_free = false;
         selected_block->process_id = process_id;
+        process_blocks[process_id][selected_block->start_address] = selected_block;
+        if(!relocations.empty()) retire_relocations(process_id, selected_block->start_address, request_size);
 
         successful_allocs++;
         return (long long) selected_block->start_address;
     }
 
+    //Enough free memory, just not in one piece: let incremental compaction gather it
+    if(compact_budget > 0 && !space->compacting && strategy != AllocStrategy::Buddy &&
+       space->heap_size - space->heap_used >= request_size){
+        start_pass(space);
+    }
     failed_allocs++;
     return -1;
 }
 
+//A Mapping is not on the heap list: its region and resident pages go straight away
+void MemoryManager::release_owned(int pid, AddressSpace* space, MemoryBlock* block){
+    const Region* region = private_spaces ? space->find(block->start_address) : nullptr;
+    if(region == nullptr || region->kind != RegionKind::Mapping){
+        space->release_block(block);
+        return;
+    }
+    int owner = owner_of(pid);
+    auto found = process_page_tables.find(owner);
+    if(found != process_page_tables.end()){
+        for(size_t page = block->start_address / page_size; page * page_size < block->start_address + block->size; page++){
+            release_page(owner, found->second, page);
+        }
+    }
+    space->unmap(block->start_address);
+    block_pool.destroy(block);
+}
+
 void MemoryManager::deallocate(int process_id){
-    MemoryBlock* current = head;
-    bool found = false;
+    MEMSIM_PROBE(instrumentation, Probe::Deallocate);
+    AddressSpace* space = space_of(process_id);
+    note_operation(space);
+    Recount recount_after{*this, space};
+    size_t freed_objects = (space && space->slabs) ? space->slabs->free_process(process_id) : 0;
+    auto owned = process_blocks.find(process_id);
+    //Blocks freed one by one leave the pages they touched behind, which this still releases
+    bool has_pages = process_page_tables.count(process_id) || process_frames.count(process_id);
+    if(owned == process_blocks.end() && freed_objects == 0 && !spaces.count(process_id) && !has_pages){
+        if(verbose) std::cout << "Error: Process ID " << process_id << " not found.\n";
+        return;
+    }
+    if(verbose && freed_objects > 0){
+        std::cout << "Process " << process_id << " released " << freed_objects << " slab objects.\n";
+    }
 
-    while(current!=nullptr){
-        //find the blockassigned to this process 
-        if(!current->is_free && current->process_id==process_id){
-            current->is_free=true;
-            current->process_id = -1;
-            found = true;
-            
-            //coalescing logic
-            //Seperate if condition for buddy 
-            bool merged = true;
-            while(merged){
-                merged = false;
-
-                //Buddy specific coalescing
-                if(current_strategy == "Buddy"){
-                    // A block's buddy is found by xoring the address with the size
-                    size_t buddy_addr = current->start_address ^ current->size;
-
-                    if(current->next && current->next->is_free && 
-                       current->next->start_address == buddy_addr &&
-                       current->next->size == current->size){
-                        
-                        MemoryBlock* temp = current->next;
-                        current->size += temp->size;
-                        current->next = temp->next;
-                        if(temp->next) temp->next->prev = current;
-                        delete temp;
-                        merged = true;
-                    }
-                    else if(current->prev && current->prev->is_free &&
-                            current->prev->start_address == buddy_addr && 
-                            current->prev->size == current->size){
-                        
-                        MemoryBlock* prev_block = current->prev;
-                        prev_block->size += current->size;
-                        prev_block->next = current->next;
-                        if(current->next) current->next->prev = prev_block;
-                        MemoryBlock* to_delete = current;
-                        current = prev_block;
-                        delete to_delete;
-                        merged = true;
-                    }
-                }
-                else{
-                    // If not buddy
-                    //1. Checks if the next block is also free
-                    if(current->next!=nullptr && current->next->is_free){
-                        MemoryBlock* temp = current->next;
-                        current->size+=temp->size;
-                        current->next = temp->next;
-                        if(temp->next!=nullptr){
-                            temp->next->prev = current;
-                        }
-                        delete temp;
-                        merged = true;
-                    }
-
-                    //2. checks if previous block is also free
-                    if(current->prev!=nullptr && current->prev->is_free){
-                        MemoryBlock* prev_block = current->prev;
-                        prev_block->size+=current->size; 
-                        prev_block->next = current->next;
-                        if(current->next != nullptr){
-                            current->next->prev = prev_block;
-                        }
-                        MemoryBlock* to_delete = current;
-                        current = prev_block;
-                        delete to_delete;
-                        merged = true;
-                    }
-                }
-            }
+    relocations.erase(process_id);
 
-            std::cout << "Process " << process_id << " deallocated and memory coalesced.\n";
+    //Only the blocks this process owns are visited, in address order.
+    //A private space ends with its process, so its heap blocks are not even released
+    bool ends_space = (spaces.count(process_id) > 0);
+    if(owned != process_blocks.end()){
+        for(auto& pair : owned->second){
+            if(!ends_space) release_owned(process_id, space, pair.second);
+            if(verbose) std::cout << "Process " << process_id << " deallocated and memory coalesced.\n";
         }
-        current = current->next;
+        if(ends_space) delete_space(process_id);
+        process_blocks.erase(process_id);
     }
+    else if(ends_space){
+        delete_space(process_id);
+    }
+    if(ends_space) recount_after.space = nullptr;
 
-    if(found){
-        std::cout << "Process " << process_id << " virtual memory deallocated.\n";
+    if(verbose) std::cout << "Process " << process_id << " virtual memory deallocated.\n";
 
-        int freed_frames = 0;
-        for(size_t i = 0; i<total_frames; i++){
-            if(frame_table[i] == process_id){
-                frame_table[i] = -1;
-                freed_frames++;
-            }
+    int freed_frames = 0;
+    auto resident = process_frames.find(process_id);
+    if(resident != process_frames.end()){
+        for(int frame : resident->second){
+            frame_table[frame] = -1;
+            return_free_frame(frame);
+            page_policy->on_release(frame);
+            freed_frames++;
+        }
+        process_frames.erase(resident);
+    }
+    if(verbose) std::cout << " -> Released " << freed_frames << " physical frames.\n";
+
+    if(process_page_tables.find(process_id) != process_page_tables.end()){
+        delete process_page_tables[process_id];
+        process_page_tables.erase(process_id);
+    }
+    if(swap) drop_swap_copies(process_id);
+    tlb->invalidate_pid(process_id);
+    if(scheduler) scheduler->release(process_id);
+}
+
+void MemoryManager::deallocate(int process_id, size_t address){
+    MEMSIM_PROBE(instrumentation, Probe::Deallocate);
+    AddressSpace* space = space_of(process_id);
+    note_operation(space);
+    if(space == nullptr){
+        if(verbose){
+            std::cout << "Error: PID " << process_id << " has no allocation at 0x"
+                      << std::hex << address << std::dec << ".\n";
+        }
+        return;
+    }
+    Recount recount_after{*this, space};
+    size_t object_size = space->slabs ? space->slabs->free(process_id, address) : 0;
+    if(object_size > 0){
+        if(verbose){
+            std::cout << "Freed " << object_size << " bytes @ 0x" << std::hex << address << std::dec
+                      << " for PID " << process_id << " (slab).\n";
         }
-        std::cout << " -> Released " << freed_frames << " physical frames.\n";
+        return;
+    }
+
+    //A block moved by compaction is freed by the address the process was given
+    size_t current = address;
+    auto moved = relocations.find(process_id);
+    if(moved != relocations.end()){
+        auto entry = moved->second.by_address.find(address);
+        if(entry != moved->second.by_address.end()) current = entry->second->start_address;
+    }
 
-        if(process_page_tables.find(process_id) != process_page_tables.end()){
-            delete process_page_tables[process_id];
-            process_page_tables.erase(process_id);
+    auto owned = process_blocks.find(process_id);
+    if(owned == process_blocks.end() || owned->second.find(current) == owned->second.end()){
+        if(verbose){
+            std::cout << "Error: PID " << process_id << " has no allocation at 0x"
+                      << std::hex << address << std::dec << ".\n";
         }
-    } else {
-        std::cout << "Error: Process ID " << process_id << " not found.\n";
+        return;
+    }
+
+    MemoryBlock* block = owned->second[current];
+    size_t size = block->size;
+    forget_relocation(process_id, block);
+    release_owned(process_id, space, block);
+    owned->second.erase(current);
+    if(owned->second.empty()) process_blocks.erase(owned);
+
+    // Heap pages stay mapped, like a real heap that keeps freed memory in the process
+    if(verbose){
+        std::cout << "Freed " << size << " bytes @ 0x" << std::hex << address << std::dec
+                  << " for PID " << process_id << ".\n";
     }
 }
 
-void MemoryManager::display_stats(){
-    size_t used_memory = 0;
-    size_t free_memory = 0;
-    size_t largest_free_block = 0;
-    int free_block_count = 0;
+//Over every space: the free memory outside each space's largest free block
+double MemoryManager::external_fragmentation() const{
+    size_t free_memory = heap_size_total - heap_used_total;
+    if(free_memory == 0) return 0.0;
+    return (1.0 - (static_cast<double>(largest_free_total) / free_memory)) * 100.0;
+}
 
-    MemoryBlock* current = head;
-    while(current!=nullptr){
-        if(current->is_free){
-            free_memory += current->size;
-            if(current->size > largest_free_block){
-                largest_free_block = current->size;
-            }
-            free_block_count++;
+size_t MemoryManager::relocate(int pid, size_t address) const{
+    auto moved = relocations.find(pid);
+    if(moved == relocations.end()) return address;
+    auto entry = moved->second.by_address.upper_bound(address);
+    if(entry == moved->second.by_address.begin()) return address;
+    --entry;
+    if(address >= entry->first + entry->second->size) return address;
+    return entry->second->start_address + (address - entry->first);
+}
+
+void MemoryManager::forget_relocation(int pid, MemoryBlock* block){
+    auto moved = relocations.find(pid);
+    if(moved == relocations.end()) return;
+    auto entry = moved->second.address_of.find(block);
+    if(entry == moved->second.address_of.end()) return;
+    moved->second.by_address.erase(entry->second);
+    moved->second.address_of.erase(entry);
+    if(moved->second.by_address.empty()) relocations.erase(moved);
+}
+
+//The new block wins its addresses back: a moved block whose old range it overlaps
+//is then only reachable at its new address (and freed with the process)
+void MemoryManager::retire_relocations(int pid, size_t address, size_t size){
+    auto moved = relocations.find(pid);
+    if(moved == relocations.end()) return;
+    std::map<size_t, MemoryBlock*>& by_address = moved->second.by_address;
+    auto entry = by_address.upper_bound(address);
+    if(entry != by_address.begin() && std::prev(entry)->first + std::prev(entry)->second->size > address) --entry;
+    while(entry != by_address.end() && entry->first < address + size){
+        moved->second.address_of.erase(entry->second);
+        entry = by_address.erase(entry);
+    }
+    if(by_address.empty()) relocations.erase(moved);
+}
+
+//Blocks are contiguous, so only the neighbours of near can overlap the page.
+//Slabs count as in use: they hold objects of any process
+bool MemoryManager::page_in_use(int pid, size_t page, MemoryBlock* near) const{
+    size_t from = page * page_size;
+    size_t to = from + page_size;
+    for(MemoryBlock* current = near; current != nullptr && current->start_address < to; current = current->next){
+        if(current->start_address + current->size > from && !current->is_free &&
+           (current->process_id == pid || current->process_id == SLAB_OWNER)) return true;
+    }
+    for(MemoryBlock* current = near->prev; current != nullptr && current->start_address + current->size > from; current = current->prev){
+        if(current->start_address < to && !current->is_free &&
+           (current->process_id == pid || current->process_id == SLAB_OWNER)) return true;
+    }
+    return false;
+}
+
+//Gives a resident page's frame back; returns the cache lines of the frame that were dropped
+size_t MemoryManager::release_page(int pid, PageTable* table, size_t page){
+    if(swap) drop_swap_copy(pid, page); // the page is given up, not evicted
+    PageTableEntry* entry = table->lookup(page);
+    if(entry == nullptr || !entry->valid) return 0;
+    int frame = entry->frame_number;
+    table->invalidate(page);
+    tlb->invalidate(pid, page);
+    frame_table[frame] = -1;
+    return_free_frame(frame);
+    page_policy->on_release(frame);
+    process_frames[pid].erase(frame);
+    return caches->invalidate_range((size_t)frame * page_size, page_size);
+}
+
+//Bytes [from, to) of the destination frame (addresses of one page) take the bytes found
+//distance further up, source page by source page. A source page that is not resident
+//held only zeros. Moves go down, so a byte is read before its own destination is written
+void MemoryManager::copy_bytes(PageTable* table, int frame, size_t from, size_t to, size_t distance){
+    for(size_t at = from; at < to;){
+        size_t source = at + distance;
+        size_t chunk = std::min(to - at, page_size - source % page_size);
+        uint8_t* out = &frame_data[(size_t)frame * page_size + at % page_size];
+        PageTableEntry* entry = table->lookup(source / page_size);
+        if(entry != nullptr && entry->valid){
+            std::memmove(out, &frame_data[(size_t)entry->frame_number * page_size + source % page_size], chunk);
         } else {
-            used_memory += current->size;
+            std::fill(out, out + chunk, 0);
         }
-        current = current->next;
+        at += chunk;
     }
+}
 
-    double utilization = (static_cast<double>(used_memory)/total_size) * 100.0;
+void MemoryManager::fix_up_pages(int pid, size_t old_start, MemoryBlock* block){
+    int owner = owner_of(pid);
+    auto found = process_page_tables.find(owner);
+    if(found == process_page_tables.end()) return;
+    PageTable* table = found->second;
+    size_t new_start = block->start_address;
+    size_t new_end = new_start + block->size;
+    size_t distance = old_start - new_start;
 
-    //External fragmentation calculation
-    double fragmentation = 0;
-    if(free_memory>0){
-        fragmentation = (1.0 - (static_cast<double>(largest_free_block)/free_memory)) * 100.0;
+    //Frames of the block stay put until the copy is done: a destination page fault
+    //must not evict a source page, nor a destination page already filled
+    std::vector<int> pinned;
+    auto pin = [&](int frame){
+        if(pinned_frames[frame]) return;
+        pinned_frames[frame] = 1;
+        pinned.push_back(frame);
+    };
+    for(size_t page = old_start / page_size; page * page_size < old_start + block->size; page++){
+        PageTableEntry* entry = table->lookup(page);
+        if(entry != nullptr && entry->valid) pin(entry->frame_number);
+    }
+    //Runs between accesses: pages loaded now count as loaded just before the next one
+    size_t now = memory_accesses;
+
+    //Maps a page of the owner to a new frame, filled from its swap copy (or zeros)
+    auto load = [&](size_t page){
+        int frame = get_free_frame_or_evict(owner, now);
+        table->map(page, frame);
+        frame_page[frame] = page;
+        if(swap) page_in(owner, page, frame);
+        pin(frame);
+        return table->lookup(page);
+    };
+
+    //1. A destination page receives the copy if any of its source bytes were resident
+    //   (or, with swap, are in a swap copy: that page is read back for the copy).
+    //   The copy bypasses the caches, so their lines of the destination go stale
+    for(size_t page = new_start / page_size; page * page_size < new_end; page++){
+        size_t from = std::max(page * page_size, new_start);
+        size_t to = std::min((page + 1) * page_size, new_end);
+        bool resident = false;
+        for(size_t source = (from + distance) / page_size; source * page_size < to + distance; source++){
+            PageTableEntry* entry = table->lookup(source);
+            if((entry == nullptr || !entry->valid) && swap && has_swap_copy(owner, source)) entry = load(source);
+            if(entry != nullptr && entry->valid) resident = true;
+        }
+        if(!resident) continue;
+
+        PageTableEntry* entry = table->lookup(page);
+        if(entry == nullptr || !entry->valid){
+            entry = load(page);
+            compaction.pages_remapped++;
+        }
+        pin(entry->frame_number);
+        if(swap) copy_bytes(table, entry->frame_number, from, to, distance);
+        entry->dirty = true;
+        compaction.lines_invalidated += caches->invalidate_range(
+            (size_t)entry->frame_number * page_size + (from - page * page_size), to - from);
+    }
+    for(int frame : pinned) pinned_frames[frame] = 0;
+
+    //2. Source pages the process has no block on any more are given back
+    for(size_t page = old_start / page_size; page * page_size < old_start + block->size; page++){
+        PageTableEntry* entry = table->lookup(page);
+        if(entry == nullptr || !entry->valid || page_in_use(pid, page, block)) continue;
+        compaction.lines_invalidated += release_page(owner, table, page);
+        compaction.frames_released++;
+    }
+}
+
+void MemoryManager::move_block(AddressSpace* space, MemoryBlock* gap, MemoryBlock* block){
+    int pid = block->process_id;
+    size_t old_start = block->start_address;
+
+    //The process keeps using the address allocate gave it. A block retired from its
+    //first address is reached at its current one, unless that already leads to another
+    //moved block (it was that block's before): the older relocation keeps it
+    Relocations& moved = relocations[pid];
+    if(moved.address_of.find(block) == moved.address_of.end()){
+        auto next = moved.by_address.lower_bound(old_start + block->size);
+        bool shadowed = next != moved.by_address.begin() &&
+                        std::prev(next)->first + std::prev(next)->second->size > old_start;
+        if(!shadowed){
+            moved.by_address[old_start] = block;
+            moved.address_of[block] = old_start;
+        }
+        if(moved.by_address.empty()) relocations.erase(pid);
     }
+    process_blocks[pid].erase(old_start);
+    space->swap_with_gap(gap, block);
+    process_blocks[pid][block->start_address] = block;
+
+    //The copy streams every line through DRAM: one read and one write each
+    size_t line = cache_levels[0].block_size;
+    simulated_cycles += 2 * latency.dram * ((block->size + line - 1) / line);
+    fix_up_pages(pid, old_start, block);
+
+    compaction.blocks_moved++;
+    compaction.bytes_moved += block->size;
+}
+
+void MemoryManager::start_pass(AddressSpace* space){
+    space->compacting = true;
+    space->compact_cursor = 0;
+    space->pass_fragmentation = space->fragmentation();
+}
+
+void MemoryManager::end_pass(AddressSpace* space){
+    space->compacting = false;
+    space->compact_cursor = 0;
+    compaction.passes++;
+    double recovered = space->pass_fragmentation - space->fragmentation();
+    if(recovered > 0) compaction.fragmentation_recovered += recovered;
+    space->last_pass_changes = space->heap_changes;
+}
+
+//Each call is one pause: at least one block moves, then it stops once budget bytes have
+size_t MemoryManager::compact_step(AddressSpace* space, size_t budget){
+    MEMSIM_PROBE(instrumentation, Probe::Compact);
+    unsigned long long start_cycles = simulated_cycles;
+    size_t moved = 0;
+    bool finished = false;
+    while(moved < budget){
+        MemoryBlock* gap = space->free_index.first_from(space->compact_cursor);
+        if(gap == nullptr || gap->next == nullptr){
+            finished = true;
+            break;
+        }
+        MemoryBlock* block = gap->next;
+        if(block->is_free || block->process_id == SLAB_OWNER){
+            //Slabs hold objects of every process and stay where they are
+            space->compact_cursor = block->start_address + block->size;
+            continue;
+        }
+        move_block(space, gap, block);
+        moved += block->size;
+        space->compact_cursor = block->start_address + block->size;
+    }
+
+    if(moved > 0){
+        unsigned long long pause = simulated_cycles - start_cycles;
+        compaction.pauses++;
+        compaction.pause_cycles += pause;
+        if(pause > compaction.max_pause_cycles) compaction.max_pause_cycles = pause;
+    }
+    if(finished) end_pass(space);
+    return moved;
+}
+
+//Every space in turn: the pause of each is counted on its own
+bool MemoryManager::compact(){
+    if(strategy == AllocStrategy::Buddy) return false;
+    std::vector<AddressSpace*> all(1, shared_space);
+    if(private_spaces){
+        std::map<int, AddressSpace*> by_pid(spaces.begin(), spaces.end());
+        all.clear();
+        for(auto& pair : by_pid) all.push_back(pair.second);
+    }
+    for(AddressSpace* space : all){
+        start_pass(space);
+        compact_step(space, (size_t)-1);
+        recount(space);
+    }
+    return true;
+}
+
+void MemoryManager::set_compaction(size_t budget, double threshold){
+    compact_budget = budget;
+    compact_threshold = threshold;
+    if(budget > 0) return;
+    shared_space->compacting = false;
+    shared_space->compact_cursor = 0;
+    for(auto& pair : spaces){
+        pair.second->compacting = false;
+        pair.second->compact_cursor = 0;
+    }
+}
+
+SimulationSummary MemoryManager::summarize() const{
+    SimulationSummary summary;
+
+    //Free blocks live in the fit index or in the buddy engine of each space, never both
+    summary.total_memory = total_size;
+    summary.used_memory = heap_used_total + mapped_total;
+    summary.free_memory = heap_size_total - heap_used_total;
+    summary.largest_free_block = largest_free_blocks.empty() ? 0 : *largest_free_blocks.rbegin();
+    summary.free_block_count = (int)free_block_total;
+    summary.address_spaces = private_spaces ? spaces.size() : 1;
+    summary.mapped_bytes = mapped_total;
+
+    summary.utilization = (static_cast<double>(summary.used_memory)/total_size) * 100.0;
+
+    //External fragmentation calculation
+    summary.fragmentation = external_fragmentation();
 
     // Success rate 
-    double success_rate = (total_allocs == 0) ? 0.0 :
-                          ((double)successful_allocs / total_allocs) * 100.0;
+    summary.malloc_requests = total_allocs;
+    summary.successful_mallocs = successful_allocs;
+    summary.success_rate = (total_allocs == 0) ? 0.0 :
+                           ((double)successful_allocs / total_allocs) * 100.0;
+    summary.internal_fragmentation = internal_fragmentation;
+
+    summary.occupied_frames = (int)(total_frames - free_frame_count);
+    summary.total_frames = total_frames;
+    summary.phys_utilization = (static_cast<double>(summary.occupied_frames) / total_frames) * 100.0;
+
+    //Average memory access time, including translation and fault service
+    summary.amat = (memory_accesses == 0) ? 0.0 : (double)simulated_cycles / memory_accesses;
+    summary.page_walks = page_walks;
+    summary.avg_walk_depth = (page_walks == 0) ? 0.0 : (double)page_walk_levels / page_walks;
+
+    summary.page_faults = page_faults;
+    summary.page_evictions = page_evictions;
+    summary.page_writebacks = page_writebacks;
+    summary.simulated_cycles = simulated_cycles;
+    summary.memory_accesses = memory_accesses;
+
+    summary.tlb_hits = tlb->get_hits();
+    summary.tlb_misses = tlb->get_misses();
+    long long tlb_total = summary.tlb_hits + summary.tlb_misses;
+    summary.tlb_hit_ratio = (tlb_total == 0) ? 0.0 : (double)summary.tlb_hits / tlb_total * 100.0;
+    for(size_t level = 0; level < caches->level_count(); level++){
+        summary.cache_hits.push_back(caches->level_hits(level));
+        summary.cache_misses.push_back(caches->level_misses(level));
+        summary.cache_hit_ratios.push_back(caches->hit_ratio(level));
+        summary.prefetches.push_back(caches->prefetches(level));
+        summary.useful_prefetches.push_back(caches->useful_prefetches(level));
+        summary.late_prefetches.push_back(caches->late_prefetches(level));
+    }
+    summary.dram_bytes = caches->get_dram_read_bytes() + caches->get_dram_write_bytes();
+    summary.prefetch_dram_bytes = caches->get_prefetch_dram_bytes();
+    summary.prefetch_unused_bytes = caches->get_unused_prefetch_bytes();
+    summary.prefetch_pollution_bytes = caches->get_pollution_dram_bytes();
 
-    int occupied_frames = 0;
-    for(int i=0; i<(int)total_frames; i++){
-        if(frame_table[i] != -1) occupied_frames++;
+    summary.slab_count = slab_stats.slabs;
+    summary.slab_bytes = slab_stats.slab_bytes;
+    summary.slab_live_bytes = slab_stats.live_bytes;
+    summary.slab_cache_hit_ratio = slab_stats.cache_hit_ratio();
+    summary.avg_allocate_ns = Instrumentation::enabled() ? instrumentation.mean_ns(Probe::Allocate) : 0.0;
+    summary.compaction_bytes_moved = compaction.bytes_moved;
+    summary.compaction_pauses = compaction.pauses;
+    summary.max_compaction_pause = compaction.max_pause_cycles;
+    if(swap){
+        SwapStats io = swap->get_stats();
+        summary.swap_bytes_written = io.pages_written * page_size;
+        summary.swap_bytes_read = swap_ins * page_size;
+        summary.swap_overlap = io.overlap();
+        summary.swap_integrity_errors = integrity_errors;
     }
-    double phys_utilization = (static_cast<double>(occupied_frames) / total_frames) * 100.0;
+    return summary;
+}
+
+void MemoryManager::note_operation(AddressSpace* space){
+    //Incremental compaction of the space the operation works in: a pass starts when its
+    //fragmentation crosses the threshold (once per change of its heap), then every
+    //operation moves up to the budget
+    if(compact_budget > 0 && space != nullptr && strategy != AllocStrategy::Buddy){
+        if(!space->compacting && space->heap_changes != space->last_pass_changes &&
+           space->fragmentation() >= compact_threshold){
+            start_pass(space);
+        }
+        if(space->compacting){
+            compact_step(space, compact_budget);
+            recount(space);
+        }
+    }
+
+    if(!sampler) return;
+    if(sampler->due()) sampler->write(summarize());
+    sampler->count_operation();
+}
+
+void MemoryManager::set_sampler(StatsSampler* stats_sampler){
+    sampler = stats_sampler;
+    if(sampler) sampler->restart_window();
+}
+
+void MemoryManager::write_sample(){
+    if(sampler) sampler->write(summarize());
+}
+
+//Stable schema "memsim-stats/1": fields may be added, never renamed or removed
+void MemoryManager::write_json(std::ostream& out){
+    flush_swap();
+    SimulationSummary s = summarize();
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(4);
+
+    out << "{\n  \"schema\": \"memsim-stats/1\",\n";
+    out << "  \"memory\": {\"total_bytes\": " << total_size << ", \"heap_bytes\": " << heap_size_total
+        << ", \"used_bytes\": " << s.used_memory << ", \"free_bytes\": " << s.free_memory
+        << ", \"largest_free_block\": " << s.largest_free_block << ", \"free_blocks\": " << s.free_block_count
+        << ", \"utilization\": " << s.utilization << ", \"external_fragmentation\": " << s.fragmentation
+        << ", \"internal_fragmentation_bytes\": " << s.internal_fragmentation
+        << ", \"strategy\": \"" << current_strategy << "\"},\n";
+    out << "  \"address_spaces\": {\"mode\": \"" << (private_spaces ? "private" : "shared")
+        << "\", \"spaces\": " << s.address_spaces << ", \"mappings\": " << mapping_total
+        << ", \"mapped_bytes\": " << s.mapped_bytes << "},\n";
+    out << "  \"slab\": {\"slabs\": " << s.slab_count << ", \"slab_bytes\": " << s.slab_bytes
+        << ", \"live_objects\": " << slab_stats.live_objects << ", \"live_bytes\": " << s.slab_live_bytes
+        << ", \"cache_hit_ratio\": " << s.slab_cache_hit_ratio << "},\n";
+    out << "  \"compaction\": {\"budget\": " << compact_budget << ", \"passes\": " << compaction.passes
+        << ", \"blocks_moved\": " << compaction.blocks_moved << ", \"bytes_moved\": " << compaction.bytes_moved
+        << ", \"pauses\": " << compaction.pauses << ", \"pause_cycles\": " << compaction.pause_cycles
+        << ", \"max_pause_cycles\": " << compaction.max_pause_cycles
+        << ", \"pages_remapped\": " << compaction.pages_remapped << ", \"frames_released\": " << compaction.frames_released
+        << ", \"lines_invalidated\": " << compaction.lines_invalidated
+        << ", \"fragmentation_recovered\": " << compaction.fragmentation_recovered << "},\n";
+    out << "  \"allocations\": {\"requests\": " << total_allocs << ", \"succeeded\": " << successful_allocs
+        << ", \"failed\": " << failed_allocs << ", \"success_rate\": " << s.success_rate << "},\n";
+    out << "  \"paging\": {\"page_size\": " << page_size << ", \"frames\": " << total_frames
+        << ", \"occupied_frames\": " << s.occupied_frames << ", \"physical_utilization\": " << s.phys_utilization
+        << ", \"policy\": \"" << page_policy->name() << "\", \"faults\": " << page_faults
+        << ", \"evictions\": " << page_evictions << ", \"dirty_evictions\": " << page_writebacks
+        << ", \"walks\": " << page_walks << ", \"avg_walk_depth\": " << s.avg_walk_depth
+        << ", \"segmentation_faults\": " << segmentation_faults << "},\n";
+    if(swap){
+        SwapStats io = swap->get_stats();
+        out << "  \"swap\": {\"pages_out\": " << swap_outs << ", \"pages_written\": " << io.pages_written
+            << ", \"bytes_written\": " << s.swap_bytes_written << ", \"batches\": " << io.batches
+            << ", \"pages_in\": " << swap_ins << ", \"bytes_read\": " << s.swap_bytes_read
+            << ", \"clean_evictions\": " << clean_evictions << ", \"slots_in_use\": " << io.slots_in_use
+            << ", \"slot_high_water\": " << io.slot_high_water << ", \"overlap\": " << s.swap_overlap
+            << ", \"integrity_errors\": " << integrity_errors << "},\n";
+    }
+    out << "  \"tlb\": {\"hits\": " << s.tlb_hits << ", \"misses\": " << s.tlb_misses
+        << ", \"hit_ratio\": " << s.tlb_hit_ratio << "},\n";
+    out << "  \"caches\": {\"inclusion\": \"" << CacheHierarchy::inclusion_name(cache_inclusion)
+        << "\", \"cores\": " << (scheduler ? scheduler->get_cores() : 1) << ", \"levels\": [";
+    for(size_t i = 0; i < cache_levels.size(); i++){
+        const CacheLevelConfig& level = cache_levels[i];
+        out << (i ? ", " : "") << "{\"level\": " << (i + 1) << ", \"size\": " << level.size
+            << ", \"block_size\": " << level.block_size << ", \"assoc\": " << level.assoc
+            << ", \"policy\": \"" << level.policy << "\", \"write_back\": " << (level.write_back ? "true" : "false")
+            << ", \"hits\": " << s.cache_hits[i] << ", \"misses\": " << s.cache_misses[i]
+            << ", \"hit_ratio\": " << s.cache_hit_ratios[i];
+        if(!level.prefetcher.empty()){
+            out << ", \"prefetch\": {\"model\": \"" << level.prefetcher << "\", \"issued\": " << s.prefetches[i]
+                << ", \"useful\": " << s.useful_prefetches[i] << ", \"late\": " << s.late_prefetches[i]
+                << ", \"accuracy\": " << CacheHierarchy::prefetch_accuracy(s.prefetches[i], s.useful_prefetches[i])
+                << ", \"coverage\": " << CacheHierarchy::prefetch_coverage(s.useful_prefetches[i], s.cache_misses[i]) << "}";
+        }
+        out << "}";
+    }
+    out << "], \"dram_read_bytes\": " << caches->get_dram_read_bytes()
+        << ", \"dram_write_bytes\": " << caches->get_dram_write_bytes()
+        << ", \"prefetch_dram_bytes\": " << s.prefetch_dram_bytes
+        << ", \"prefetch_unused_bytes\": " << s.prefetch_unused_bytes
+        << ", \"prefetch_pollution_bytes\": " << s.prefetch_pollution_bytes << "},\n";
+    out << "  \"clock\": {\"accesses\": " << memory_accesses << ", \"cycles\": " << simulated_cycles
+        << ", \"amat\": " << s.amat << "},\n";
+    out << "  \"instrumentation\": ";
+    instrumentation.write_json(out);
+    out << "\n}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+//A partial batch stays staged until it fills: without this the totals would leave it out
+void MemoryManager::flush_swap(){
+    if(swap) swap->flush();
+}
+
+void MemoryManager::display_stats(){
+    flush_swap();
+    SimulationSummary summary = summarize();
 
     std::cout << "\n========== MEMORY STATISTICS ==========\n";
     std::cout << "Total Memory:    " << total_size << " bytes\n";
-    std::cout << "Used Memory:     " << used_memory << " bytes\n";
-    std::cout << "Free Memory:     " << free_memory << " bytes\n";
-    std::cout << "Utilization (Virtual): " << std::fixed << std::setprecision(2) << utilization << "% (Overcommitment)\n";
-    std::cout << "Utilization (Physical):" << phys_utilization << "% (" << occupied_frames << "/" << total_frames << " frames)\n";
-    std::cout << "Internal Fragmentation: " << internal_fragmentation << " bytes\n";
-    std::cout << "Allocation Succes Rate: " << success_rate << "%\n";
-    std::cout << "External Fragmentation:   " << fragmentation << "%\n";
-    std::cout << "Free Block Count: " << free_block_count << "\n";
-    std::cout << "\nL1 "; l1_cache->display_stats();
-    std::cout << "L2 "; l2_cache->display_stats();
+    std::cout << "Used Memory:     " << summary.used_memory << " bytes\n";
+    std::cout << "Free Memory:     " << summary.free_memory << " bytes\n";
+    std::cout << "Utilization (Virtual): " << std::fixed << std::setprecision(2) << summary.utilization << "% (Overcommitment)\n";
+    std::cout << "Utilization (Physical):" << summary.phys_utilization << "% (" << summary.occupied_frames << "/" << total_frames << " frames)\n";
+    std::cout << "Internal Fragmentation: " << summary.internal_fragmentation << " bytes\n";
+    std::cout << "Allocation Succes Rate: " << summary.success_rate << "%\n";
+    std::cout << "External Fragmentation:   " << summary.fragmentation << "%\n";
+    std::cout << "Free Block Count: " << summary.free_block_count << "\n";
+    if(Instrumentation::enabled()) std::cout << "Avg Allocation Cost: " << summary.avg_allocate_ns << " ns\n";
+    if(private_spaces){
+        std::cout << "Address Spaces: " << summary.address_spaces << " (private) | Heaps: " << heap_size_total
+                  << " bytes | Mappings: " << mapping_total << " (" << summary.mapped_bytes << " bytes)\n";
+    }
+    if(strategy == AllocStrategy::Slab || summary.slab_count > 0) slab_stats.display();
+    if(compaction.passes > 0 || compaction.pauses > 0){
+        double mean_pause = (compaction.pauses == 0) ? 0.0 : (double)compaction.pause_cycles / compaction.pauses;
+        std::cout << "Compaction: " << compaction.passes << " passes | Moved: " << compaction.blocks_moved << " blocks ("
+                  << compaction.bytes_moved << " bytes) | Pauses: " << compaction.pauses << " (max "
+                  << compaction.max_pause_cycles << ", mean " << mean_pause << " cycles) | Fragmentation Recovered: "
+                  << compaction.fragmentation_recovered << " points\n";
+        std::cout << "   Pages Remapped: " << compaction.pages_remapped << " | Frames Released: " << compaction.frames_released
+                  << " | Cache Lines Invalidated: " << compaction.lines_invalidated << "\n";
+    }
+    std::cout << "Page Faults: " << page_faults << " | Evictions: " << page_evictions
+              << " (" << page_writebacks << " dirty) | Page Policy: " << page_policy->name() << "\n";
+    std::cout << "Simulated Cycles: " << simulated_cycles << "\n";
+    std::cout << "Avg Memory Access Time: " << summary.amat << " cycles\n";
+    std::cout << "Page Walks: " << page_walks << " | Avg Walk Depth: " << summary.avg_walk_depth
+              << " / " << page_table_levels << " levels\n";
+    if(segmentation_faults > 0) std::cout << "Segmentation Faults: " << segmentation_faults << "\n";
+    if(swap){
+        SwapStats io = swap->get_stats();
+        std::cout << "Swap: " << swap->get_path() << " | Out: " << swap_outs << " pages (" << io.pages_written << " written, "
+                  << io.pages_written * page_size << " bytes in " << io.batches << " batches, " << io.writes
+                  << " writes) | In: " << swap_ins << " pages (" << swap_ins * page_size << " bytes) | Clean Evictions: "
+                  << clean_evictions << "\n";
+        std::cout << "   Slots: " << io.slots_in_use << " in use / " << io.slot_high_water << " | Write-back Overlap: "
+                  << io.overlap() << "% (" << io.io_seconds * 1000.0 << " ms writing, " << io.stall_seconds * 1000.0
+                  << " ms stalled) | Integrity Errors: " << integrity_errors;
+        if(io.write_errors > 0) std::cout << " | Write Errors: " << io.write_errors;
+        std::cout << "\n";
+    }
+    std::cout << "\nTLB "; tlb->display_stats();
+    if(scheduler) scheduler->display_stats();
+    caches->display_stats();
     std::cout << "=======================================\n";
 }
 //Simple Visualization for debugging
 void MemoryManager::dump_memory(){
-    MemoryBlock* current = head;
     std::cout << "\n----Memory Dump----\n";
+    if(!private_spaces){
+        dump_heap(shared_space);
+    } else {
+        std::map<int, AddressSpace*> by_pid(spaces.begin(), spaces.end());
+        for(auto& pair : by_pid){
+            const std::map<size_t, Region>& regions = pair.second->get_regions();
+            std::cout << "PID " << pair.first << ": " << regions.size() << " regions\n";
+            dump_heap(pair.second);
+            for(auto& region : regions){
+                if(region.second.kind != RegionKind::Mapping) continue;
+                std::cout << "[Mapping: 0x" << std::hex << region.second.start << std::dec
+                          << " | Size: " << region.second.size << "]\n";
+            }
+        }
+    }
+    std::cout << "--------------------\n";
+}
+
+void MemoryManager::dump_heap(const AddressSpace* space) const{
+    MemoryBlock* current = space->head;
     while(current!=nullptr){
         std::cout << "[Addr: " << std::setw(4) << current->start_address
                   << " | Size: " << std::setw(4) << current->size
-                  << " | " << (current->is_free ? "FREE" : "USED (PID:" + std::to_string(current->process_id) + ")")
+                  << " | " << (current->is_free ? "FREE" :
+                      current->process_id == SLAB_OWNER ? std::string("SLAB") :
+                      "USED (PID:" + std::to_string(current->process_id) + ")")
                   << "]\n";
         current = current->next;
     }
-    std::cout << "--------------------\n";
 }
@@ -1,25 +1,87 @@
 #include "../include/PageTable.hpp"
 
-PageTable::PageTable(size_t pg_size) : page_size(pg_size){}
+PageTable::PageTable(size_t pg_size, int num_levels, int bits)
+    : page_size(pg_size), levels(num_levels), bits_per_level(bits) {
+    if(levels < 1 || bits_per_level < 1 || bits_per_level > MAX_BITS_PER_LEVEL || levels * bits_per_level > 64){
+        std::cerr << "Error: Invalid Page Table Geometry, using 4 levels of 9 bits\n";
+        levels = 4;
+        bits_per_level = 9;
+    }
+    fanout = (size_t)1 << bits_per_level;
+    if(levels == 1) root.entries = new PageTableEntry[fanout]();
+    else root.children = new Node*[fanout]();
+}
 
-int PageTable::translate(int page_num){
-    if(entries.find(page_num)!=entries.end() && entries[page_num].valid){
-        return entries[page_num].frame_number;
+PageTable::~PageTable(){
+    destroy(root, 0);
+}
+
+void PageTable::destroy(Node& node, int level){
+    if(node.children){
+        for(size_t i = 0; i < fanout; i++){
+            if(node.children[i]){
+                destroy(*node.children[i], level + 1);
+                delete node.children[i];
+            }
+        }
+        delete[] node.children;
     }
-    return -1; //Indicates a page fault
+    delete[] node.entries;
+}
+
+size_t PageTable::index_at(size_t page_num, int level) const{
+    int shift = (levels - 1 - level) * bits_per_level;
+    return (page_num >> shift) & (fanout - 1);
+}
+
+bool PageTable::covers(size_t page_num) const{
+    int total_bits = levels * bits_per_level;
+    return total_bits >= 64 || (page_num >> total_bits) == 0;
 }
 
-void PageTable::map(int page_num, int frame_num){
-    entries[page_num] = {frame_num, true};
+int PageTable::translate(size_t page_num){
+    Node* node = &root;
+    int depth = 1;
+    for(int level = 0; level < levels - 1; level++){
+        node = node->children[index_at(page_num, level)];
+        if(node == nullptr) break; // nothing mapped under this index
+        depth++;
+    }
+    last_depth = depth;
+    if(node == nullptr) return -1;
+
+    PageTableEntry& entry = node->entries[index_at(page_num, levels - 1)];
+    if(!entry.valid) return -1; //-1 Indicates a page fault
+    entry.referenced = true; // the walk sets the accessed bit, like the MMU does
+    return entry.frame_number;
 }
 
-void PageTable::invalidate_frame(int frame_num){
-    for(auto& pair : entries){
-        //Find the page that points to the victim frame
-        if(pair.second.frame_number == frame_num && pair.second.valid){
-            pair.second.valid = false; // Mark as on DISK
-            std::cout << "[PAGE TABLE] Page " << pair.first << " is now INVALID (evicted from frame " << frame_num << ")\n";
-            return;
+void PageTable::map(size_t page_num, int frame_num){
+    Node* node = &root;
+    for(int level = 0; level < levels - 1; level++){
+        Node*& child = node->children[index_at(page_num, level)];
+        if(child == nullptr){
+            child = new Node();
+            if(level + 1 == levels - 1) child->entries = new PageTableEntry[fanout]();
+            else child->children = new Node*[fanout]();
         }
+        node = child;
+    }
+    node->entries[index_at(page_num, levels - 1)] = {frame_num, true, true, false};
+}
+
+PageTableEntry* PageTable::lookup(size_t page_num){
+    Node* node = &root;
+    for(int level = 0; level < levels - 1 && node != nullptr; level++){
+        node = node->children[index_at(page_num, level)];
     }
-}
\ No newline at end of file
+    if(node == nullptr) return nullptr;
+    return &node->entries[index_at(page_num, levels - 1)];
+}
+
+void PageTable::invalidate(size_t page_num){
+    PageTableEntry* entry = lookup(page_num);
+    if(entry != nullptr){
+        entry->valid = false; // Mark as on DISK
+    }
+}
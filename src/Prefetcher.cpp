@@ -0,0 +1,167 @@
+#include "../include/Prefetcher.hpp"
+#include <sstream>
+
+//On a miss, or the first use of a prefetched line (tagged prefetching, so a
+//sequential scan keeps going): lines +distance .. +distance+degree-1
+class NextLinePrefetcher : public Prefetcher{
+public:
+    NextLinePrefetcher(size_t lines, size_t ahead){
+        degree = lines ? lines : 1;
+        distance = ahead ? ahead : 1;
+    }
+    const char* name() const override { return "Next-Line"; }
+
+    void observe(size_t line, bool miss, bool prefetch_hit, std::vector<size_t>& out) override{
+        if(!miss && !prefetch_hit) return;
+        for(size_t i = 0; i < degree; i++) out.push_back(line + distance + i);
+    }
+};
+
+//Without a PC to tell the streams apart, accesses are grouped by region (64 lines).
+//Each region remembers its last line and stride; once the same stride has been seen
+//twice in a row the next `degree` strides, starting `distance` strides ahead, are fetched
+class StridePrefetcher : public Prefetcher{
+private:
+    static const size_t REGION_SHIFT = 6;
+    static const size_t ENTRIES = 64; // direct mapped by region
+    static const int CONFIDENT = 2;
+
+    struct Entry{
+        size_t region = 0; // + 1, 0 = empty
+        size_t last = 0;
+        long long stride = 0;
+        int confidence = 0; // saturates at 3
+    };
+    std::vector<Entry> table;
+
+public:
+    StridePrefetcher(size_t lines, size_t ahead) : table(ENTRIES) {
+        degree = lines ? lines : 2;
+        distance = ahead ? ahead : 1;
+    }
+    const char* name() const override { return "Stride"; }
+
+    void observe(size_t line, bool, bool, std::vector<size_t>& out) override{
+        size_t region = line >> REGION_SHIFT;
+        Entry& entry = table[region % ENTRIES];
+        if(entry.region != region + 1){
+            entry = Entry();
+            entry.region = region + 1;
+            entry.last = line;
+            return;
+        }
+        long long delta = (long long)line - (long long)entry.last;
+        if(delta == 0) return;
+        entry.last = line;
+        if(delta == entry.stride){
+            if(entry.confidence < 3) entry.confidence++;
+        } else if(entry.confidence > 0){
+            entry.confidence--;
+        } else {
+            entry.stride = delta;
+        }
+        if(entry.confidence < CONFIDENT) return;
+
+        for(size_t i = 0; i < degree; i++){
+            long long target = (long long)line + entry.stride * (long long)(distance + i);
+            if(target >= 0) out.push_back((size_t)target);
+        }
+    }
+};
+
+//Stream buffer style detector: a miss next to (within 2 lines of) a recent miss starts
+//a stream in that direction. Each trigger in the stream's window then fetches up to
+//`degree` more lines, never more than `distance` lines ahead of the demand
+class StreamPrefetcher : public Prefetcher{
+private:
+    static const size_t STREAMS = 8;
+
+    struct Stream{
+        bool valid = false;
+        size_t last = 0;      // newest demand line
+        long long dir = 0;    // +1, -1, or 0 while training
+        long long next = 0;   // next line to fetch
+        size_t used = 0;      // for LRU replacement
+    };
+    std::vector<Stream> streams;
+    size_t clock = 0;
+
+    bool matches(const Stream& s, size_t line) const{
+        long long delta = (long long)line - (long long)s.last;
+        if(s.dir == 0) return delta != 0 && delta >= -2 && delta <= 2;
+        long long ahead = delta * s.dir;
+        return ahead > 0 && ahead <= (long long)(distance + degree);
+    }
+
+public:
+    StreamPrefetcher(size_t lines, size_t ahead) : streams(STREAMS) {
+        degree = lines ? lines : 2;
+        distance = ahead ? ahead : 8;
+    }
+    const char* name() const override { return "Stream"; }
+
+    void observe(size_t line, bool miss, bool prefetch_hit, std::vector<size_t>& out) override{
+        if(!miss && !prefetch_hit) return;
+        clock++;
+
+        Stream* stream = nullptr;
+        for(Stream& s : streams){
+            if(s.valid && matches(s, line)){
+                stream = &s;
+                break;
+            }
+        }
+        if(!stream){
+            Stream* victim = &streams[0];
+            for(Stream& s : streams){
+                if(!s.valid){
+                    victim = &s;
+                    break;
+                }
+                if(s.used < victim->used) victim = &s;
+            }
+            *victim = Stream();
+            victim->valid = true;
+            victim->last = line;
+            victim->used = clock;
+            return;
+        }
+
+        if(stream->dir == 0) stream->dir = (line > stream->last) ? 1 : -1;
+        stream->last = line;
+        stream->used = clock;
+        long long current = (long long)line;
+        if((stream->next - current) * stream->dir <= 0) stream->next = current + stream->dir;
+        for(size_t i = 0; i < degree && (stream->next - current) * stream->dir <= (long long)distance; i++){
+            if(stream->next >= 0) out.push_back((size_t)stream->next);
+            stream->next += stream->dir;
+        }
+    }
+};
+
+Prefetcher* make_prefetcher(const std::string& name, size_t degree, size_t distance){
+    if(name == "next_line") return new NextLinePrefetcher(degree, distance);
+    if(name == "stride") return new StridePrefetcher(degree, distance);
+    if(name == "stream") return new StreamPrefetcher(degree, distance);
+    return nullptr;
+}
+
+bool parse_prefetcher(const std::string& spec, std::string& name, size_t& degree, size_t& distance){
+    std::vector<std::string> fields;
+    std::stringstream ss(spec);
+    std::string field;
+    while(std::getline(ss, field, '/')) fields.push_back(field);
+    if(fields.empty() || fields.size() > 3) return false;
+    if(fields[0] != "next_line" && fields[0] != "stride" && fields[0] != "stream") return false;
+
+    degree = distance = 0;
+    try{
+        if(fields.size() > 1) degree = std::stoull(fields[1]);
+        if(fields.size() > 2) distance = std::stoull(fields[2]);
+    } catch(...){
+        return false;
+    }
+    if((fields.size() > 1 && degree == 0) || (fields.size() > 2 && distance == 0)) return false;
+    name = fields[0];
+    return true;
+}
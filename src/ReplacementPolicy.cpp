@@ -0,0 +1,230 @@
+#include "../include/ReplacementPolicy.hpp"
+#include <set>
+#include <utility>
+#include <cstdint>
+
+// Doubly linked list of frame numbers kept in flat arrays, so every
+// operation is O(1) and no node is ever allocated
+class FrameList{
+private:
+    std::vector<int> prev;
+    std::vector<int> next;
+    std::vector<char> linked;
+    int sentinel;
+
+public:
+    FrameList(size_t frames) : prev(frames + 1), next(frames + 1), linked(frames, 0), sentinel((int)frames) {
+        prev[sentinel] = next[sentinel] = sentinel;
+    }
+
+    bool empty() const { return next[sentinel] == sentinel; }
+    int front() const { return next[sentinel]; }
+
+    void remove(int frame){
+        if(!linked[frame]) return;
+        next[prev[frame]] = next[frame];
+        prev[next[frame]] = prev[frame];
+        linked[frame] = 0;
+    }
+
+    void push_back(int frame){
+        remove(frame);
+        prev[frame] = prev[sentinel];
+        next[frame] = sentinel;
+        next[prev[sentinel]] = frame;
+        prev[sentinel] = frame;
+        linked[frame] = 1;
+    }
+};
+
+//Evicts the frame that was filled first
+class FifoPolicy : public ReplacementPolicy{
+protected:
+    FrameList queue;
+
+public:
+    FifoPolicy(size_t frames) : queue(frames) {}
+    const char* name() const override { return "FIFO"; }
+
+    void on_load(int frame, size_t) override { queue.push_back(frame); }
+    void on_release(int frame) override { queue.remove(frame); }
+
+    int pick_victim(size_t) override {
+        if(queue.empty()) return -1;
+        int victim = queue.front();
+        queue.remove(victim);
+        return victim;
+    }
+};
+
+//Evicts the frame used least recently; every access moves its frame to the back
+class LruPolicy : public FifoPolicy{
+public:
+    LruPolicy(size_t frames) : FifoPolicy(frames) {}
+    const char* name() const override { return "LRU"; }
+
+    void on_access(int frame, size_t) override { queue.push_back(frame); }
+};
+
+//FIFO order, but a frame whose page was referenced is cleared and requeued
+class SecondChancePolicy : public FifoPolicy{
+private:
+    ReferenceBitFn test_and_clear_referenced;
+
+public:
+    SecondChancePolicy(size_t frames, ReferenceBitFn ref) : FifoPolicy(frames), test_and_clear_referenced(ref) {}
+    const char* name() const override { return "Second-Chance"; }
+
+    int pick_victim(size_t) override {
+        // Terminates: a requeued frame has its bit cleared for the next pass
+        while(!queue.empty()){
+            int frame = queue.front();
+            if(!test_and_clear_referenced(frame)){
+                queue.remove(frame);
+                return frame;
+            }
+            queue.push_back(frame);
+        }
+        return -1;
+    }
+};
+
+//Circular hand over the frames, clearing referenced bits until it finds one unset
+class ClockPolicy : public ReplacementPolicy{
+private:
+    std::vector<char> resident;
+    size_t hand = 0;
+    ReferenceBitFn test_and_clear_referenced;
+
+public:
+    ClockPolicy(size_t frames, ReferenceBitFn ref) : resident(frames, 0), test_and_clear_referenced(ref) {}
+    const char* name() const override { return "Clock"; }
+
+    void on_load(int frame, size_t) override { resident[frame] = 1; }
+    void on_release(int frame) override { resident[frame] = 0; }
+
+    int pick_victim(size_t) override {
+        size_t frames = resident.size();
+        for(size_t step = 0; step < 2 * frames + 1; step++){
+            int frame = (int)hand;
+            hand = (hand + 1) % frames;
+            if(!resident[frame]) continue;
+            if(!test_and_clear_referenced(frame)){
+                resident[frame] = 0;
+                return frame;
+            }
+        }
+        return -1;
+    }
+};
+
+//WSClock: evicts a frame whose page has not been referenced within the last
+//`window` accesses; if every page is in the working set, the oldest one goes
+class WorkingSetPolicy : public ReplacementPolicy{
+private:
+    std::vector<char> resident;
+    std::vector<size_t> last_use;
+    size_t hand = 0;
+    size_t window;
+    ReferenceBitFn test_and_clear_referenced;
+
+public:
+    WorkingSetPolicy(size_t frames, ReferenceBitFn ref, size_t ws_window)
+        : resident(frames, 0), last_use(frames, 0), window(ws_window), test_and_clear_referenced(ref) {}
+    const char* name() const override { return "Working-Set"; }
+
+    void on_load(int frame, size_t now) override {
+        resident[frame] = 1;
+        last_use[frame] = now;
+    }
+    void on_release(int frame) override { resident[frame] = 0; }
+
+    int pick_victim(size_t now) override {
+        size_t frames = resident.size();
+        int oldest = -1;
+        for(size_t step = 0; step < frames; step++){
+            int frame = (int)hand;
+            hand = (hand + 1) % frames;
+            if(!resident[frame]) continue;
+
+            if(test_and_clear_referenced(frame)){
+                last_use[frame] = now; // still in the working set
+                continue;
+            }
+            if(now - last_use[frame] > window){
+                resident[frame] = 0;
+                return frame;
+            }
+            if(oldest == -1 || last_use[frame] < last_use[oldest]) oldest = frame;
+        }
+        if(oldest == -1){
+            // Everything was referenced during this sweep: fall back to the hand
+            for(size_t step = 0; step < frames && oldest == -1; step++){
+                if(resident[hand]) oldest = (int)hand;
+                hand = (hand + 1) % frames;
+            }
+        }
+        if(oldest != -1) resident[oldest] = 0;
+        return oldest;
+    }
+};
+
+//Belady: evicts the page whose next use lies furthest in the future.
+//Without a lookahead the next use is unknown and it degrades to LRU.
+class OptPolicy : public ReplacementPolicy{
+private:
+    std::set<std::pair<size_t, int>> by_next_use;
+    std::vector<size_t> key;
+    std::vector<char> tracked;
+    const std::vector<size_t>* next_use = nullptr;
+
+    size_t next_use_of(size_t now) const {
+        if(next_use && now < next_use->size()) return (*next_use)[now];
+        return SIZE_MAX - now; // oldest access looks furthest away
+    }
+
+    void track(int frame, size_t now){
+        if(tracked[frame]) by_next_use.erase({key[frame], frame});
+        key[frame] = next_use_of(now);
+        by_next_use.insert({key[frame], frame});
+        tracked[frame] = 1;
+    }
+
+public:
+    OptPolicy(size_t frames) : key(frames, 0), tracked(frames, 0) {}
+    const char* name() const override { return next_use ? "OPT" : "OPT (no lookahead, LRU)"; }
+
+    void set_lookahead(const std::vector<size_t>* lookahead) override { next_use = lookahead; }
+
+    void on_load(int frame, size_t now) override { track(frame, now); }
+    void on_access(int frame, size_t now) override { track(frame, now); }
+    void on_release(int frame) override {
+        if(!tracked[frame]) return;
+        by_next_use.erase({key[frame], frame});
+        tracked[frame] = 0;
+    }
+
+    //A skipped frame keeps the next use it had: compaction has no access index to look up
+    void on_skip(int frame, size_t) override {
+        by_next_use.insert({key[frame], frame});
+        tracked[frame] = 1;
+    }
+
+    int pick_victim(size_t) override {
+        if(by_next_use.empty()) return -1;
+        int victim = by_next_use.rbegin()->second;
+        on_release(victim);
+        return victim;
+    }
+};
+
+ReplacementPolicy* make_replacement_policy(const std::string& name, size_t frames,
+                                           ReferenceBitFn test_and_clear_referenced, size_t ws_window){
+    if(name == "fifo") return new FifoPolicy(frames);
+    if(name == "lru") return new LruPolicy(frames);
+    if(name == "second_chance") return new SecondChancePolicy(frames, test_and_clear_referenced);
+    if(name == "clock") return new ClockPolicy(frames, test_and_clear_referenced);
+    if(name == "ws") return new WorkingSetPolicy(frames, test_and_clear_referenced, ws_window);
+    if(name == "opt") return new OptPolicy(frames);
+    return nullptr;
+}
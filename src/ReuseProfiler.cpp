@@ -0,0 +1,147 @@
+#include "../include/ReuseProfiler.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+ReuseDistance::ReuseDistance(){
+    tree.assign(1024 + 1, 0);
+}
+
+void ReuseDistance::add(size_t stamp, int delta){
+    for(size_t i = stamp + 1; i < tree.size(); i += i & (~i + 1)){
+        tree[i] += delta;
+    }
+}
+
+size_t ReuseDistance::prefix(size_t end) const{
+    size_t sum = 0;
+    for(size_t i = end; i > 0; i -= i & (~i + 1)){
+        sum += tree[i];
+    }
+    return sum;
+}
+
+void ReuseDistance::compact(){
+    //Keys keep their order of last use, so every distance is preserved
+    std::vector<std::pair<size_t, uint64_t>> live;
+    live.reserve(last_use.size());
+    for(const auto& entry : last_use) live.push_back({entry.second, entry.first});
+    std::sort(live.begin(), live.end());
+
+    size_t capacity = std::max<size_t>(1024, live.size() * 2);
+    tree.assign(capacity + 1, 0);
+    for(size_t i = 0; i < live.size(); i++){
+        last_use[live[i].second] = i;
+        tree[i + 1] += 1;
+    }
+    //Linear-time Fenwick build: push each node's sum up to its parent
+    for(size_t i = 1; i <= capacity; i++){
+        size_t parent = i + (i & (~i + 1));
+        if(parent <= capacity) tree[parent] += tree[i];
+    }
+    now = live.size();
+}
+
+size_t ReuseDistance::access(uint64_t key){
+    if(now + 1 >= tree.size()) compact();
+    total++;
+
+    size_t distance = COLD;
+    auto it = last_use.find(key);
+    if(it == last_use.end()){
+        cold++;
+        last_use.emplace(key, now);
+    } else {
+        distance = prefix(now) - prefix(it->second + 1);
+        add(it->second, -1);
+        it->second = now;
+        if(distance >= histogram.size()) histogram.resize(distance + 1, 0);
+        histogram[distance]++;
+    }
+    add(now, 1);
+    now++;
+    return distance;
+}
+
+std::vector<double> ReuseDistance::miss_ratio_curve() const{
+    size_t entries = last_use.size();
+    std::vector<double> curve(entries + 1, 1.0);
+    if(total == 0) return curve;
+
+    //misses(c) = cold + accesses at distance >= c
+    size_t misses = cold;
+    for(size_t c = entries; c > 0; c--){
+        curve[c] = (double)misses / total;
+        if(c - 1 < histogram.size()) misses += histogram[c - 1];
+    }
+    curve[0] = (double)misses / total;
+    return curve;
+}
+
+double ReuseDistance::miss_ratio(size_t capacity) const{
+    if(total == 0) return 0.0;
+    size_t misses = cold;
+    for(size_t d = capacity; d < histogram.size(); d++) misses += histogram[d];
+    return (double)misses / total;
+}
+
+ReuseProfiler::ReuseProfiler(std::vector<size_t> block_sizes, size_t page_size){
+    std::sort(block_sizes.begin(), block_sizes.end());
+    block_sizes.erase(std::unique(block_sizes.begin(), block_sizes.end()), block_sizes.end());
+    for(size_t block : block_sizes){
+        curves.push_back({std::to_string(block) + "B blocks", block, ReuseDistance()});
+    }
+    curves.push_back({std::to_string(page_size) + "B pages", page_size, ReuseDistance()});
+}
+
+size_t ReuseProfiler::curve_of_block(size_t block_size) const{
+    for(size_t i = 0; i + 1 < curves.size(); i++){
+        if(curves[i].unit == block_size) return i;
+    }
+    return 0;
+}
+
+void ReuseProfiler::record(size_t physical_addr, int pid, size_t virtual_page){
+    for(size_t i = 0; i + 1 < curves.size(); i++){
+        curves[i].distances.access(physical_addr / curves[i].unit);
+    }
+    //Pages get dense ids in order of first use
+    auto id = page_ids.emplace(std::make_pair(pid, virtual_page), page_ids.size()).first->second;
+    curves.back().distances.access(id);
+}
+
+void ReuseProfiler::display(){
+    for(const Curve& curve : curves){
+        const ReuseDistance& d = curve.distances;
+        std::cout << "Reuse Profile (" << curve.name << "): " << d.get_total() << " accesses | "
+                  << d.distinct() << " distinct | " << d.get_cold() << " cold\n";
+        std::vector<double> mrc = d.miss_ratio_curve();
+        for(size_t entries = 1; ; entries *= 2){
+            size_t c = std::min(entries, mrc.size() - 1);
+            std::cout << "  " << std::setw(8) << entries << " x " << curve.unit << "B = "
+                      << std::setw(10) << entries * curve.unit << "B -> Miss Ratio: "
+                      << std::fixed << std::setprecision(2) << mrc[c] * 100.0 << "%\n";
+            if(entries >= mrc.size() - 1) break;
+        }
+    }
+}
+
+bool ReuseProfiler::write_csv(const std::string& path) const{
+    std::ofstream out(path);
+    if(!out) return false;
+
+    out << "curve,unit_bytes,entries,bytes,miss_ratio\n";
+    out << std::setprecision(6) << std::fixed;
+    for(const Curve& curve : curves){
+        std::vector<double> mrc = curve.distances.miss_ratio_curve();
+        const std::vector<size_t>& histogram = curve.distances.get_histogram();
+        for(size_t c = 0; c < mrc.size(); c++){
+            //The curve only drops at c where some access had distance c - 1
+            bool step = (c == 0 || c == mrc.size() - 1 || (c - 1 < histogram.size() && histogram[c - 1] > 0));
+            if(!step) continue;
+            out << curve.name << "," << curve.unit << "," << c << "," << c * curve.unit << "," << mrc[c] << "\n";
+        }
+    }
+    return true;
+}
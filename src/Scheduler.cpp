@@ -0,0 +1,42 @@
+#include "../include/Scheduler.hpp"
+#include <iostream>
+#include <algorithm>
+
+Scheduler::Scheduler(size_t core_count, const std::string& policy, size_t slice)
+    : cores(core_count == 0 ? 1 : core_count), round_robin(policy == "rr"), quantum(slice == 0 ? 1 : slice) {
+    load.assign(cores, 0);
+}
+
+bool Scheduler::is_policy(const std::string& policy){
+    return policy == "affinity" || policy == "rr";
+}
+
+size_t Scheduler::core_for(int pid){
+    auto it = placements.find(pid);
+    if(it == placements.end()){
+        size_t home = std::min_element(load.begin(), load.end()) - load.begin();
+        load[home]++;
+        it = placements.emplace(pid, Placement{home, home}).first;
+    }
+
+    size_t core = it->second.home;
+    if(round_robin) core = (core + ticks / quantum) % cores;
+    ticks++;
+
+    if(core != it->second.last) migrations++;
+    it->second.last = core;
+    return core;
+}
+
+void Scheduler::release(int pid){
+    auto it = placements.find(pid);
+    if(it == placements.end()) return;
+    load[it->second.home]--;
+    placements.erase(it);
+}
+
+void Scheduler::display_stats(){
+    std::cout << "Cores: " << cores << " | Scheduler: " << (round_robin ? "Round Robin" : "Affinity");
+    if(round_robin) std::cout << " (quantum " << quantum << ")";
+    std::cout << " | Migrations: " << migrations << "\n";
+}
@@ -0,0 +1,274 @@
+#include "../include/ShardedMemoryManager.hpp"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+//Shard of the process owner, for any sign of PID
+static size_t home_shard(int owner, size_t count){
+    long long n = (long long)count;
+    return (size_t)(((owner % n) + n) % n);
+}
+
+ShardedMemoryManager::ShardedMemoryManager(size_t size, size_t shard_count){
+    if(shard_count == 0) shard_count = 1;
+    for(size_t i = 0; i < shard_count; i++){
+        Shard* shard = new Shard();
+        shard->sim = new MemoryManager(size / shard_count);
+        shard->sim->set_verbose(false);
+        shards.push_back(shard);
+    }
+}
+
+ShardedMemoryManager::~ShardedMemoryManager(){
+    for(Shard* shard : shards){
+        delete shard->sim;
+        delete shard;
+    }
+}
+
+ShardedMemoryManager::Shard& ShardedMemoryManager::acquire(size_t index, bool counted) const{
+    Shard& shard = *shards[index];
+    bool waited = !shard.lock.try_lock();
+    if(waited) shard.lock.lock();
+    if(!counted) return shard;
+    shard.acquisitions++;
+    if(waited) shard.contended++;
+    return shard;
+}
+
+//Until the first thread is registered every PID is its own owner, and the table is not read
+size_t ShardedMemoryManager::shard_of(int pid) const{
+    int owner = pid;
+    if(has_threads.load(std::memory_order_acquire)){
+        std::shared_lock<std::shared_mutex> read(routing_lock);
+        auto found = thread_owner.find(pid);
+        if(found != thread_owner.end()) owner = found->second;
+    }
+    return home_shard(owner, shards.size());
+}
+
+long long ShardedMemoryManager::allocate(size_t size, int process_id){
+    Shard& shard = acquire(shard_of(process_id));
+    std::lock_guard<std::mutex> guard(shard.lock, std::adopt_lock);
+    return shard.sim->allocate(size, process_id);
+}
+
+void ShardedMemoryManager::deallocate(int process_id){
+    Shard& shard = acquire(shard_of(process_id));
+    std::lock_guard<std::mutex> guard(shard.lock, std::adopt_lock);
+    shard.sim->deallocate(process_id);
+}
+
+void ShardedMemoryManager::deallocate(int process_id, size_t address){
+    Shard& shard = acquire(shard_of(process_id));
+    std::lock_guard<std::mutex> guard(shard.lock, std::adopt_lock);
+    shard.sim->deallocate(process_id, address);
+}
+
+void ShardedMemoryManager::access_memory(size_t virtual_addr, int pid, bool write){
+    Shard& shard = acquire(shard_of(pid));
+    std::lock_guard<std::mutex> guard(shard.lock, std::adopt_lock);
+    shard.sim->access_memory(virtual_addr, pid, write);
+}
+
+//A thread cannot move to another shard: what it allocated stays where it ran
+int ShardedMemoryManager::thread_shard(int tid, int pid) const{
+    if(tid == pid || thread_owner.count(pid)) return -1;
+    size_t target = home_shard(pid, shards.size());
+    auto found = thread_owner.find(tid);
+    if(found != thread_owner.end() && home_shard(found->second, shards.size()) != target) return -1;
+    return (int)target;
+}
+
+int ShardedMemoryManager::route_thread(int tid, int pid){
+    std::unique_lock<std::shared_mutex> write(routing_lock);
+    int target = thread_shard(tid, pid);
+    if(target == -1) return -1;
+    thread_owner[tid] = pid;
+    has_threads.store(true, std::memory_order_release);
+    return target;
+}
+
+//The table stays write-locked until the shard has agreed, so no call sees half a registration
+bool ShardedMemoryManager::add_thread(int tid, int pid){
+    std::unique_lock<std::shared_mutex> write(routing_lock);
+    int target = thread_shard(tid, pid);
+    if(target == -1) return false;
+
+    Shard& shard = acquire(target);
+    std::lock_guard<std::mutex> guard(shard.lock, std::adopt_lock);
+    if(!shard.sim->add_thread(tid, pid)) return false;
+    thread_owner[tid] = pid;
+    has_threads.store(true, std::memory_order_release);
+    return true;
+}
+
+void ShardedMemoryManager::run_on(size_t index, const std::function<void(MemoryManager&)>& work){
+    Shard& shard = acquire(index);
+    std::lock_guard<std::mutex> guard(shard.lock, std::adopt_lock);
+    work(*shard.sim);
+}
+
+void ShardedMemoryManager::configure(const std::function<void(MemoryManager&)>& setup){
+    for(size_t i = 0; i < shards.size(); i++) configure_shard(i, setup);
+}
+
+void ShardedMemoryManager::configure_shard(size_t index, const std::function<void(MemoryManager&)>& setup){
+    Shard& shard = acquire(index, false);
+    std::lock_guard<std::mutex> guard(shard.lock, std::adopt_lock);
+    setup(*shard.sim);
+}
+
+SimulationSummary ShardedMemoryManager::summarize() const{
+    SimulationSummary total;
+    double fragmented = 0;   // free bytes outside each shard's largest free block, weighted
+    double walk_levels = 0;
+    double slab_hits = 0;    // weighted by malloc requests, as SlabStats is per shard
+    double allocate_ns = 0;
+    double overlapped = 0;   // swap bytes written while the simulation ran on
+
+    for(size_t i = 0; i < shards.size(); i++){
+        Shard& shard = acquire(i, false);
+        SimulationSummary part;
+        {
+            std::lock_guard<std::mutex> guard(shard.lock, std::adopt_lock);
+            part = shard.sim->summarize();
+        }
+        total.total_memory += part.total_memory;
+        total.used_memory += part.used_memory;
+        total.free_memory += part.free_memory;
+        total.largest_free_block = std::max(total.largest_free_block, part.largest_free_block);
+        total.free_block_count += part.free_block_count;
+        total.occupied_frames += part.occupied_frames;
+        total.total_frames += part.total_frames;
+        fragmented += part.fragmentation * part.free_memory;
+        total.internal_fragmentation += part.internal_fragmentation;
+        total.malloc_requests += part.malloc_requests;
+        total.successful_mallocs += part.successful_mallocs;
+        total.page_faults += part.page_faults;
+        total.page_evictions += part.page_evictions;
+        total.page_writebacks += part.page_writebacks;
+        total.simulated_cycles += part.simulated_cycles;
+        total.memory_accesses += part.memory_accesses;
+        total.page_walks += part.page_walks;
+        walk_levels += part.avg_walk_depth * part.page_walks;
+        total.tlb_hits += part.tlb_hits;
+        total.tlb_misses += part.tlb_misses;
+        if(total.cache_hits.size() < part.cache_hits.size()){
+            total.cache_hits.resize(part.cache_hits.size(), 0);
+            total.cache_misses.resize(part.cache_misses.size(), 0);
+            total.prefetches.resize(part.prefetches.size(), 0);
+            total.useful_prefetches.resize(part.useful_prefetches.size(), 0);
+            total.late_prefetches.resize(part.late_prefetches.size(), 0);
+        }
+        for(size_t level = 0; level < part.cache_hits.size(); level++){
+            total.cache_hits[level] += part.cache_hits[level];
+            total.cache_misses[level] += part.cache_misses[level];
+            total.prefetches[level] += part.prefetches[level];
+            total.useful_prefetches[level] += part.useful_prefetches[level];
+            total.late_prefetches[level] += part.late_prefetches[level];
+        }
+        total.dram_bytes += part.dram_bytes;
+        total.prefetch_dram_bytes += part.prefetch_dram_bytes;
+        total.prefetch_unused_bytes += part.prefetch_unused_bytes;
+        total.prefetch_pollution_bytes += part.prefetch_pollution_bytes;
+        total.slab_count += part.slab_count;
+        total.slab_bytes += part.slab_bytes;
+        total.slab_live_bytes += part.slab_live_bytes;
+        slab_hits += part.slab_cache_hit_ratio * part.malloc_requests;
+        allocate_ns += part.avg_allocate_ns * part.malloc_requests;
+        total.compaction_bytes_moved += part.compaction_bytes_moved;
+        total.compaction_pauses += part.compaction_pauses;
+        total.max_compaction_pause = std::max(total.max_compaction_pause, part.max_compaction_pause);
+        total.address_spaces += part.address_spaces;
+        total.mapped_bytes += part.mapped_bytes;
+        total.swap_bytes_written += part.swap_bytes_written;
+        total.swap_bytes_read += part.swap_bytes_read;
+        overlapped += part.swap_overlap * part.swap_bytes_written;
+        total.swap_integrity_errors += part.swap_integrity_errors;
+    }
+
+    total.utilization = (total.total_memory == 0) ? 0.0 : (double)total.used_memory / total.total_memory * 100.0;
+    total.phys_utilization = (total.total_frames == 0) ? 0.0 : (double)total.occupied_frames / total.total_frames * 100.0;
+    total.fragmentation = (total.free_memory == 0) ? 0.0 : fragmented / total.free_memory;
+    total.success_rate = (total.malloc_requests == 0) ? 0.0 : (double)total.successful_mallocs / total.malloc_requests * 100.0;
+    total.amat = (total.memory_accesses == 0) ? 0.0 : (double)total.simulated_cycles / total.memory_accesses;
+    total.avg_walk_depth = (total.page_walks == 0) ? 0.0 : walk_levels / total.page_walks;
+    long long tlb_total = total.tlb_hits + total.tlb_misses;
+    total.tlb_hit_ratio = (tlb_total == 0) ? 0.0 : (double)total.tlb_hits / tlb_total * 100.0;
+    for(size_t level = 0; level < total.cache_hits.size(); level++){
+        long long accesses = total.cache_hits[level] + total.cache_misses[level];
+        total.cache_hit_ratios.push_back((accesses == 0) ? 0.0 : (double)total.cache_hits[level] / accesses * 100.0);
+    }
+    total.slab_cache_hit_ratio = (total.malloc_requests == 0) ? 0.0 : slab_hits / total.malloc_requests;
+    total.avg_allocate_ns = (total.malloc_requests == 0) ? 0.0 : allocate_ns / total.malloc_requests;
+    total.swap_overlap = (total.swap_bytes_written == 0) ? 0.0 : overlapped / total.swap_bytes_written;
+    return total;
+}
+
+void ShardedMemoryManager::display_stats(){
+    configure([](MemoryManager& sim){ sim.flush_swap(); });
+    SimulationSummary summary = summarize();
+
+    std::cout << "\n========== SHARDED STATISTICS ==========\n";
+    std::cout << "Shards: " << shards.size() << " (" << summary.total_memory / shards.size() << " bytes of RAM each)\n";
+    std::cout << "Total Memory:    " << summary.total_memory << " bytes\n";
+    std::cout << "Used Memory:     " << summary.used_memory << " bytes\n";
+    std::cout << "Free Memory:     " << summary.free_memory << " bytes\n";
+    std::cout << "Utilization (Virtual): " << std::fixed << std::setprecision(2) << summary.utilization << "% (Overcommitment)\n";
+    std::cout << "Utilization (Physical):" << summary.phys_utilization << "% (" << summary.occupied_frames << "/"
+              << summary.total_frames << " frames)\n";
+    std::cout << "Internal Fragmentation: " << summary.internal_fragmentation << " bytes\n";
+    std::cout << "Allocation Succes Rate: " << summary.success_rate << "%\n";
+    std::cout << "External Fragmentation:   " << summary.fragmentation << "%\n";
+    std::cout << "Free Block Count: " << summary.free_block_count << "\n";
+    std::cout << "Address Spaces: " << summary.address_spaces << " | Mapped: " << summary.mapped_bytes << " bytes\n";
+    if(summary.slab_count > 0){
+        std::cout << "Slabs: " << summary.slab_count << " (" << summary.slab_bytes << " bytes) | Live: "
+                  << summary.slab_live_bytes << " bytes | PID Cache Hit Ratio: " << summary.slab_cache_hit_ratio << "%\n";
+    }
+    if(summary.compaction_pauses > 0){
+        std::cout << "Compaction: Moved " << summary.compaction_bytes_moved << " bytes | Pauses: " << summary.compaction_pauses
+                  << " (max " << summary.max_compaction_pause << " cycles)\n";
+    }
+    std::cout << "Page Faults: " << summary.page_faults << " | Evictions: " << summary.page_evictions
+              << " (" << summary.page_writebacks << " dirty)\n";
+    if(summary.swap_bytes_written > 0 || summary.swap_bytes_read > 0){
+        std::cout << "Swap: " << summary.swap_bytes_written << " bytes written | " << summary.swap_bytes_read
+                  << " bytes read | Write-back Overlap: " << summary.swap_overlap << "% | Integrity Errors: "
+                  << summary.swap_integrity_errors << "\n";
+    }
+    std::cout << "Simulated Cycles: " << summary.simulated_cycles << "\n";
+    std::cout << "Avg Memory Access Time: " << summary.amat << " cycles\n";
+    std::cout << "Page Walks: " << summary.page_walks << " | Avg Walk Depth: " << summary.avg_walk_depth << "\n";
+    std::cout << "\nTLB Hits: " << summary.tlb_hits << " | Misses: " << summary.tlb_misses
+              << " | Hit Ratio: " << summary.tlb_hit_ratio << "%\n";
+    for(size_t level = 0; level < summary.cache_hits.size(); level++){
+        std::cout << "L" << (level + 1) << " Hits: " << summary.cache_hits[level] << " | Misses: " << summary.cache_misses[level]
+                  << " | Hit Ratio: " << summary.cache_hit_ratios[level] << "%\n";
+        if(summary.prefetches[level] == 0) continue;
+        std::cout << "   Prefetch Issued: " << summary.prefetches[level] << " | Useful: " << summary.useful_prefetches[level]
+                  << " | Accuracy: " << CacheHierarchy::prefetch_accuracy(summary.prefetches[level], summary.useful_prefetches[level])
+                  << "% | Coverage: " << CacheHierarchy::prefetch_coverage(summary.useful_prefetches[level], summary.cache_misses[level])
+                  << "% | Late: " << summary.late_prefetches[level] << "\n";
+    }
+    std::cout << "DRAM Traffic: " << summary.dram_bytes << " bytes";
+    if(summary.prefetch_dram_bytes > 0){
+        std::cout << " (" << summary.prefetch_dram_bytes << " issued by prefetches, "
+                  << summary.prefetch_unused_bytes + summary.prefetch_pollution_bytes << " extra: "
+                  << summary.prefetch_unused_bytes << " unused, " << summary.prefetch_pollution_bytes << " pollution misses)";
+    }
+    std::cout << "\n";
+
+    //Per shard: how evenly the PIDs spread, and how often a call had to wait for the lock
+    for(size_t i = 0; i < shards.size(); i++){
+        Shard& shard = acquire(i, false);
+        std::lock_guard<std::mutex> guard(shard.lock, std::adopt_lock);
+        SimulationSummary part = shard.sim->summarize();
+        double waits = (shard.acquisitions == 0) ? 0.0 : (double)shard.contended / shard.acquisitions * 100.0;
+        std::cout << "Shard " << i << ": Mallocs: " << part.malloc_requests << " | Accesses: " << part.memory_accesses
+                  << " | Page Faults: " << part.page_faults << " | Lock Acquisitions: " << shard.acquisitions
+                  << " (" << waits << "% contended)\n";
+    }
+    std::cout << "=======================================\n";
+}
@@ -0,0 +1,220 @@
+#include "../include/SlabAllocator.hpp"
+#include <iomanip>
+
+// 16 B steps up to 128, 32 B steps up to 256, 64 B steps up to 512
+static const size_t CLASS_SIZES[SlabAllocator::CLASS_COUNT] = {
+    16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512
+};
+
+SlabAllocator::SlabAllocator(TakeSpanFn take, ReturnSpanFn give_back, SlabStats& totals)
+    : take_span(take), return_span(give_back), partial(CLASS_COUNT), stats(totals) {}
+
+SlabAllocator::~SlabAllocator(){
+    for(auto& entry : slabs){
+        stats.slab_bytes -= entry.second->span->size;
+        delete entry.second;
+    }
+    stats.slabs -= slabs.size();
+    for(auto& process : owned){
+        for(auto& object : process.second) stats.live_bytes -= class_size(object.second);
+        stats.live_objects -= process.second.size();
+    }
+    stats.cached_objects -= cached_objects;
+}
+
+size_t SlabAllocator::class_of(size_t size){
+    if(size <= 128) return (size == 0) ? 0 : (size - 1) / 16;
+    if(size <= 256) return 8 + (size - 129) / 32;
+    return 12 + (size - 257) / 64;
+}
+
+size_t SlabAllocator::class_size(size_t index){
+    return CLASS_SIZES[index];
+}
+
+size_t SlabAllocator::span_size(size_t index){
+    size_t span = CLASS_SIZES[index] * 8;
+    return (span < 1024) ? 1024 : span;
+}
+
+SlabAllocator::Slab* SlabAllocator::slab_of(size_t address) const{
+    auto it = slabs.upper_bound(address);
+    if(it == slabs.begin()) return nullptr;
+    --it;
+    Slab* slab = it->second;
+    return (address < slab->span->start_address + slab->span->size) ? slab : nullptr;
+}
+
+void SlabAllocator::add_partial(Slab* slab){
+    std::vector<Slab*>& list = partial[slab->size_class];
+    slab->partial_index = list.size();
+    list.push_back(slab);
+}
+
+void SlabAllocator::remove_partial(Slab* slab){
+    std::vector<Slab*>& list = partial[slab->size_class];
+    Slab* last = list.back();
+    list[slab->partial_index] = last;
+    last->partial_index = slab->partial_index;
+    list.pop_back();
+    slab->partial_index = NOT_PARTIAL;
+}
+
+bool SlabAllocator::grow(size_t size_class){
+    MemoryBlock* span = take_span(span_size(size_class));
+    if(span == nullptr) return false;
+
+    Slab* slab = new Slab{span, size_class, span->size / class_size(size_class), {}, NOT_PARTIAL};
+    //Highest address first, so objects are handed out in address order
+    for(size_t i = slab->capacity; i-- > 0; ){
+        slab->free_objects.push_back(span->start_address + i * class_size(size_class));
+    }
+    slabs[span->start_address] = slab;
+    stats.slabs++;
+    stats.slab_bytes += span->size;
+    add_partial(slab);
+    return true;
+}
+
+bool SlabAllocator::refill(Cache& cache, size_t size_class){
+    std::vector<size_t>& objects = cache.objects;
+    while(objects.size() < cache.batch){
+        if(partial[size_class].empty() && !grow(size_class)){
+            //Out of heap: pull back what the other caches hold, then try once more. Even
+            //with no slab emptied, their objects of this class are in the pool now
+            drain_caches(&cache);
+            if(partial[size_class].empty() && !grow(size_class)) break;
+        }
+        Slab* slab = partial[size_class].back();
+        while(objects.size() < cache.batch && !slab->free_objects.empty()){
+            objects.push_back(slab->free_objects.back());
+            slab->free_objects.pop_back();
+            cached_objects++;
+            stats.cached_objects++;
+        }
+        if(slab->free_objects.empty()) remove_partial(slab);
+    }
+    if(cache.batch < BATCH) cache.batch *= 2;
+
+    //The cache pops from the back: lowest address first
+    for(size_t i = 0, j = objects.size(); i + 1 < j; i++, j--) std::swap(objects[i], objects[j - 1]);
+    return !objects.empty();
+}
+
+void SlabAllocator::release_object(size_t address){
+    Slab* slab = slab_of(address);
+    if(slab->free_objects.empty()) add_partial(slab);
+    slab->free_objects.push_back(address);
+    if(slab->free_objects.size() < slab->capacity) return;
+
+    //Every object is back: the span returns to the heap
+    remove_partial(slab);
+    slabs.erase(slab->span->start_address);
+    stats.slabs--;
+    stats.slab_bytes -= slab->span->size;
+    return_span(slab->span);
+    delete slab;
+}
+
+long long SlabAllocator::allocate(int pid, size_t size){
+    size_t size_class = class_of(size);
+    std::vector<Cache>& classes = caches[pid];
+    if(classes.empty()) classes.resize(CLASS_COUNT);
+    std::vector<size_t>& cache = classes[size_class].objects;
+
+    stats.allocations++;
+    if(!cache.empty()) stats.cache_hits++;
+    else if(!refill(classes[size_class], size_class)) return -1;
+
+    size_t address = cache.back();
+    cache.pop_back();
+    cached_objects--;
+    stats.cached_objects--;
+    owned[pid][address] = size_class;
+    stats.live_objects++;
+    stats.live_bytes += class_size(size_class);
+    return (long long)address;
+}
+
+size_t SlabAllocator::free(int pid, size_t address){
+    auto process = owned.find(pid);
+    if(process == owned.end()) return 0;
+    auto object = process->second.find(address);
+    if(object == process->second.end()) return 0;
+
+    size_t size_class = object->second;
+    process->second.erase(object);
+    stats.live_objects--;
+    stats.live_bytes -= class_size(size_class);
+
+    std::vector<size_t>& cache = caches[pid][size_class].objects;
+    cache.push_back(address);
+    cached_objects++;
+    stats.cached_objects++;
+    if(cache.size() > CACHE_LIMIT){
+        //Return the older half, keep the recently freed (warm) objects
+        size_t keep = CACHE_LIMIT / 2;
+        for(size_t i = 0; i + keep < cache.size(); i++) release_object(cache[i]);
+        cached_objects -= cache.size() - keep;
+        stats.cached_objects -= cache.size() - keep;
+        cache.erase(cache.begin(), cache.end() - keep);
+    }
+    return class_size(size_class);
+}
+
+size_t SlabAllocator::free_process(int pid){
+    size_t freed = 0;
+    auto process = owned.find(pid);
+    if(process != owned.end()){
+        for(auto& object : process->second){
+            stats.live_bytes -= class_size(object.second);
+            release_object(object.first);
+        }
+        freed = process->second.size();
+        stats.live_objects -= freed;
+        owned.erase(process);
+    }
+
+    //The process is gone, so is its cache
+    auto cached = caches.find(pid);
+    if(cached != caches.end()){
+        for(Cache& cache : cached->second){
+            for(size_t address : cache.objects) release_object(address);
+            cached_objects -= cache.objects.size();
+            stats.cached_objects -= cache.objects.size();
+        }
+        caches.erase(cached);
+    }
+    return freed;
+}
+
+size_t SlabAllocator::scavenge(){
+    return drain_caches(nullptr);
+}
+
+size_t SlabAllocator::drain_caches(const Cache* keep){
+    if(cached_objects == 0) return 0;
+    size_t before = stats.slab_bytes;
+    for(auto& process : caches){
+        for(Cache& cache : process.second){
+            if(&cache == keep) continue;
+            for(size_t address : cache.objects) release_object(address);
+            cached_objects -= cache.objects.size();
+            stats.cached_objects -= cache.objects.size();
+            cache.objects.clear();
+            cache.batch = 1;
+        }
+    }
+    return before - stats.slab_bytes;
+}
+
+double SlabStats::cache_hit_ratio() const{
+    return (allocations == 0) ? 0.0 : (double)cache_hits / allocations * 100.0;
+}
+
+void SlabStats::display() const{
+    std::cout << "Slabs: " << slabs << " (" << slab_bytes << " bytes) | Live Objects: " << live_objects
+              << " (" << live_bytes << " bytes) | Free In Slabs: " << (slab_bytes - live_bytes)
+              << " bytes (" << cached_objects << " objects in PID caches) | PID Cache Hit Ratio: "
+              << std::fixed << std::setprecision(2) << cache_hit_ratio() << "%\n";
+}
@@ -0,0 +1,60 @@
+#include "../include/StatsSampler.hpp"
+#include <iomanip>
+
+//Percentage of part in whole, 0 for an empty window
+static double percent(long long part, long long whole){
+    return (whole <= 0) ? 0.0 : (double)part / whole * 100.0;
+}
+
+bool StatsSampler::open(const std::string& path, size_t every){
+    out.open(path);
+    interval = (every == 0) ? 1 : every;
+    operations = 0;
+    header_written = false;
+    last_row = (size_t)-1;
+    restart_window();
+    return out.is_open();
+}
+
+void StatsSampler::restart_window(){
+    last_accesses = 0;
+    last_faults = 0;
+    last_tlb_hits = 0;
+    last_tlb_lookups = 0;
+    last_hits.clear();
+    last_lookups.clear();
+}
+
+void StatsSampler::write(const SimulationSummary& s){
+    if(!out.is_open() || operations == last_row) return;
+    last_row = operations;
+    size_t levels = s.cache_hits.size();
+    if(!header_written){
+        out << "operations,accesses,cycles,used_bytes,free_bytes,largest_free,free_blocks,"
+               "external_fragmentation,utilization,physical_utilization,fault_rate,tlb_hit_ratio";
+        for(size_t i = 0; i < levels; i++) out << ",l" << (i + 1) << "_hit_ratio";
+        out << "\n" << std::fixed << std::setprecision(2);
+        header_written = true;
+    }
+    last_hits.resize(levels, 0);
+    last_lookups.resize(levels, 0);
+
+    long long tlb_lookups = s.tlb_hits + s.tlb_misses;
+    out << operations << "," << s.memory_accesses << "," << s.simulated_cycles << ","
+        << s.used_memory << "," << s.free_memory << "," << s.largest_free_block << "," << s.free_block_count << ","
+        << s.fragmentation << "," << s.utilization << "," << s.phys_utilization << ","
+        << percent(s.page_faults - last_faults, s.memory_accesses - last_accesses) << ","
+        << percent(s.tlb_hits - last_tlb_hits, tlb_lookups - last_tlb_lookups);
+    for(size_t i = 0; i < levels; i++){
+        long long lookups = s.cache_hits[i] + s.cache_misses[i];
+        out << "," << percent(s.cache_hits[i] - last_hits[i], lookups - last_lookups[i]);
+        last_hits[i] = s.cache_hits[i];
+        last_lookups[i] = lookups;
+    }
+    out << "\n";
+
+    last_accesses = s.memory_accesses;
+    last_faults = s.page_faults;
+    last_tlb_hits = s.tlb_hits;
+    last_tlb_lookups = tlb_lookups;
+}
@@ -0,0 +1,185 @@
+#include "../include/SwapDevice.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+#include <fcntl.h>
+#include <unistd.h>
+
+double SwapStats::overlap() const{
+    if(io_seconds <= 0) return 0.0;
+    return std::max(0.0, io_seconds - stall_seconds) / io_seconds * 100.0;
+}
+
+SwapDevice::~SwapDevice(){
+    close();
+}
+
+bool SwapDevice::open(const std::string& file_path, size_t page_bytes){
+    close();
+    fd = ::open(file_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if(fd == -1) return false;
+    path = file_path;
+    page_size = page_bytes;
+    stats = SwapStats();
+    stopping = false;
+    io_thread = std::thread(&SwapDevice::run, this);
+    return true;
+}
+
+void SwapDevice::close(){
+    if(fd == -1) return;
+    flush();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    io_thread.join();
+    ::close(fd);
+    ::unlink(path.c_str());
+    fd = -1;
+    free_slots.clear();
+    pending.clear();
+}
+
+//Reused slots first, so the file only grows by the peak number of swapped pages
+size_t SwapDevice::allocate_slot(){
+    std::lock_guard<std::mutex> guard(lock);
+    stats.slots_in_use++;
+    if(free_slots.empty()) return stats.slot_high_water++;
+    size_t slot = free_slots.back();
+    free_slots.pop_back();
+    return slot;
+}
+
+//A write of the slot still queued is harmless: the slot's next write is queued after it
+void SwapDevice::free_slot(size_t slot){
+    std::lock_guard<std::mutex> guard(lock);
+    stats.slots_in_use--;
+    free_slots.push_back(slot);
+}
+
+void SwapDevice::write(size_t slot, const uint8_t* page){
+    std::unique_lock<std::mutex> guard(lock);
+    staged.slots.push_back(slot);
+    staged.data.insert(staged.data.end(), page, page + page_size);
+    pending[slot]++;
+    if(staged.slots.size() < BATCH_PAGES) return;
+    guard.unlock();
+    submit();
+}
+
+void SwapDevice::submit(){
+    std::unique_lock<std::mutex> guard(lock);
+    if(staged.slots.empty()) return;
+    if(queue.size() >= MAX_QUEUED){
+        auto start = std::chrono::steady_clock::now();
+        room.wait(guard, [this]{ return queue.size() < MAX_QUEUED; });
+        stats.stall_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    queue.push_back(std::move(staged));
+    staged = Batch();
+    stats.batches++;
+    work_ready.notify_one();
+}
+
+void SwapDevice::flush(){
+    submit();
+    std::unique_lock<std::mutex> guard(lock);
+    if(queue.empty() && !writing) return;
+    auto start = std::chrono::steady_clock::now();
+    room.wait(guard, [this]{ return queue.empty() && !writing; });
+    stats.stall_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SwapDevice::run(){
+    std::unique_lock<std::mutex> guard(lock);
+    while(true){
+        work_ready.wait(guard, [this]{ return !queue.empty() || stopping; });
+        if(queue.empty()) return;
+        in_flight = std::move(queue.front());
+        queue.pop_front();
+        writing = true;
+        guard.unlock();
+
+        auto start = std::chrono::steady_clock::now();
+        write_batch(in_flight);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        guard.lock();
+        stats.io_seconds += seconds;
+        for(size_t slot : in_flight.slots){
+            auto found = pending.find(slot);
+            if(--found->second == 0) pending.erase(found);
+        }
+        in_flight = Batch();
+        writing = false;
+        room.notify_all();
+    }
+}
+
+//Pages in slot order (later writes of a slot last), runs of consecutive slots in one pwrite.
+//Runs only the I/O thread; the counters it touches are taken under the lock by the caller
+void SwapDevice::write_batch(const Batch& batch){
+    std::vector<size_t> order(batch.slots.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b){ return batch.slots[a] < batch.slots[b]; });
+
+    std::vector<uint8_t> run_data;
+    size_t written = 0, calls = 0, errors = 0;
+    for(size_t i = 0; i < order.size(); ){
+        size_t first_slot = batch.slots[order[i]];
+        size_t j = i;
+        run_data.clear();
+        while(j < order.size() && batch.slots[order[j]] == first_slot + (j - i)){
+            const uint8_t* page = &batch.data[order[j] * page_size];
+            run_data.insert(run_data.end(), page, page + page_size);
+            j++;
+        }
+        ssize_t done = ::pwrite(fd, run_data.data(), run_data.size(), (off_t)(first_slot * page_size));
+        if(done != (ssize_t)run_data.size()) errors++;
+        written += j - i;
+        calls++;
+        i = j;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    stats.pages_written += written;
+    stats.writes += calls;
+    stats.write_errors += errors;
+}
+
+bool SwapDevice::find_newest(const Batch& batch, size_t slot, size_t page_size, uint8_t* out){
+    for(size_t i = batch.slots.size(); i-- > 0; ){
+        if(batch.slots[i] != slot) continue;
+        std::memcpy(out, &batch.data[i * page_size], page_size);
+        return true;
+    }
+    return false;
+}
+
+//A slot with writes still pending is read from the newest of them: the staged batch,
+//then the queued ones from the back, then the one being written
+bool SwapDevice::read(size_t slot, uint8_t* page){
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stats.pages_read++;
+        if(pending.count(slot)){
+            if(find_newest(staged, slot, page_size, page)) return true;
+            for(auto batch = queue.rbegin(); batch != queue.rend(); ++batch){
+                if(find_newest(*batch, slot, page_size, page)) return true;
+            }
+            if(writing && find_newest(in_flight, slot, page_size, page)) return true;
+        }
+    }
+    ssize_t done = ::pread(fd, page, page_size, (off_t)(slot * page_size));
+    if(done == (ssize_t)page_size) return true;
+    std::memset(page, 0, page_size);
+    return false;
+}
+
+SwapStats SwapDevice::get_stats(){
+    std::lock_guard<std::mutex> guard(lock);
+    return stats;
+}
@@ -0,0 +1,204 @@
+#include "../include/Sweep.hpp"
+#include "../include/ThreadPool.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+
+//Splits a grid value list on commas and whitespace
+static std::vector<std::string> split_values(const std::string& text){
+    std::string spaced = text;
+    for(char& c : spaced) if(c == ',') c = ' ';
+    std::stringstream ss(spaced);
+    std::vector<std::string> values;
+    std::string value;
+    while(ss >> value) values.push_back(value);
+    return values;
+}
+
+static bool parse_size(const std::string& text, size_t& value){
+    try{
+        size_t used;
+        value = std::stoull(text, &used);
+        return used == text.size() && value > 0;
+    } catch(...){
+        return false;
+    }
+}
+
+bool Sweep::load_grid(const std::string& path){
+    std::ifstream in(path);
+    if(!in){
+        std::cerr << "Error: Cannot open grid " << path << "\n";
+        return false;
+    }
+
+    std::string line;
+    int line_number = 0;
+    while(std::getline(in, line)){
+        line_number++;
+        size_t hash = line.find('#');
+        if(hash != std::string::npos) line.erase(hash);
+        size_t colon = line.find(':');
+        if(colon == std::string::npos){
+            if(!split_values(line).empty()){
+                std::cerr << "Error: " << path << ":" << line_number << ": expected key: values\n";
+                return false;
+            }
+            continue;
+        }
+
+        std::vector<std::string> key_words = split_values(line.substr(0, colon));
+        std::vector<std::string> values = split_values(line.substr(colon + 1));
+        std::string key = key_words.empty() ? "" : key_words[0];
+        bool ok = key_words.size() == 1 && !values.empty();
+
+        if(ok && key == "strategy"){
+            for(const std::string& v : values) ok = ok && TraceReplayer::strategy_id(v) != -1;
+            if(ok) strategies = values;
+        }
+        else if(ok && (key == "ram" || key == "page_size")){
+            std::vector<size_t> sizes;
+            for(const std::string& v : values){
+                size_t size = 0;
+                ok = ok && parse_size(v, size);
+                if(key == "page_size") ok = ok && size >= 16 && (size & (size - 1)) == 0;
+                sizes.push_back(size);
+            }
+            if(ok) (key == "ram" ? ram_sizes : page_sizes) = sizes;
+        }
+        else if(ok && key == "page_policy"){
+            for(const std::string& v : values) ok = ok && TraceReplayer::page_policy_id(v) != -1;
+            if(ok) page_policies = values;
+        }
+        else if(ok && (key == "l1" || key == "l2")){
+            CacheLevelConfig level;
+            for(const std::string& v : values){
+                ok = ok && ((key == "l2" && v == "none") || CacheHierarchy::parse_level(v, level));
+            }
+            if(ok) (key == "l1" ? l1_specs : l2_specs) = values;
+        }
+        else ok = false;
+
+        if(!ok){
+            std::cerr << "Error: " << path << ":" << line_number << ": bad grid line\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<SweepConfig> Sweep::configurations() const{
+    std::vector<SweepConfig> configs;
+    for(const std::string& strategy : strategies)
+    for(size_t ram : ram_sizes)
+    for(size_t page : page_sizes)
+    for(const std::string& policy : page_policies)
+    for(const std::string& l1 : l1_specs)
+    for(const std::string& l2 : l2_specs){
+        configs.push_back({strategy, ram, page, policy, l1, l2});
+    }
+    return configs;
+}
+
+SweepResult Sweep::run_one(const SweepConfig& config, const std::vector<TraceEvent>& events){
+    TraceReplayer replayer(config.ram_size ? config.ram_size : 1024);
+    if(config.ram_size) replayer.set_ram_size(config.ram_size);
+    if(!config.strategy.empty()) replayer.set_strategy(config.strategy);
+    if(config.page_size) replayer.set_page_size(config.page_size);
+    if(!config.page_policy.empty()) replayer.set_page_policy(config.page_policy);
+
+    std::vector<CacheLevelConfig> levels(1);
+    CacheHierarchy::parse_level(config.l1, levels[0]);
+    if(config.l2 != "none"){
+        levels.emplace_back();
+        CacheHierarchy::parse_level(config.l2, levels[1]);
+    }
+    replayer.set_caches(levels, CacheInclusion::NonInclusive);
+
+    replayer.replay_events(events);
+
+    SweepResult result;
+    result.error = replayer.get_error();
+    result.summary = replayer.get_sim()->summarize();
+    result.page_size = replayer.get_sim()->get_page_size();
+    result.events = replayer.get_event_count();
+    result.failed_mallocs = replayer.get_failed_mallocs();
+    result.elapsed_seconds = replayer.get_elapsed_seconds();
+    return result;
+}
+
+void Sweep::write_csv(std::ostream& out, const std::vector<SweepConfig>& configs,
+                      const std::vector<SweepResult>& results){
+    out << "strategy,ram,page_size,page_policy,l1,l2,events,failed_mallocs,success_rate,"
+           "external_fragmentation,internal_fragmentation,page_faults,evictions,dirty_evictions,"
+           "tlb_hit_ratio,l1_hit_ratio,l2_hit_ratio,dram_bytes,cycles,amat,elapsed_s\n";
+    for(size_t i = 0; i < configs.size(); i++){
+        const SweepConfig& c = configs[i];
+        const SweepResult& r = results[i];
+        const SimulationSummary& s = r.summary;
+        double l2_ratio = (s.cache_hit_ratios.size() > 1) ? s.cache_hit_ratios[1] : 0.0;
+
+        out << (c.strategy.empty() ? "trace" : c.strategy) << ","
+            << (c.ram_size ? std::to_string(c.ram_size) : "trace") << ","
+            << (r.error.empty() ? r.page_size : c.page_size) << ","
+            << (c.page_policy.empty() ? "trace" : c.page_policy) << ","
+            << c.l1 << "," << c.l2 << ",";
+        //A configuration that could not be applied keeps its row, with no figures
+        if(!r.error.empty()){
+            out << ",,,,,,,,,,,,,,\n";
+            continue;
+        }
+        out << r.events << "," << r.failed_mallocs << ","
+            << std::fixed << std::setprecision(2) << s.success_rate << ","
+            << s.fragmentation << "," << s.internal_fragmentation << ","
+            << s.page_faults << "," << s.page_evictions << "," << s.page_writebacks << ","
+            << s.tlb_hit_ratio << "," << s.cache_hit_ratios[0] << "," << l2_ratio << ","
+            << s.dram_bytes << "," << s.simulated_cycles << "," << s.amat << ","
+            << std::setprecision(6) << r.elapsed_seconds << "\n";
+    }
+}
+
+bool Sweep::run(const std::string& trace_path, size_t threads, const std::string& out_path){
+    std::vector<TraceEvent> events;
+    if(!TraceReplayer::load_events(trace_path, events)){
+        std::cerr << "Error: Cannot open trace " << trace_path << "\n";
+        return false;
+    }
+
+    std::vector<SweepConfig> configs = configurations();
+    std::vector<SweepResult> results(configs.size());
+
+    auto start = std::chrono::steady_clock::now();
+    size_t pool_threads;
+    {
+        ThreadPool pool(threads);
+        pool_threads = pool.get_threads();
+        //Each task writes only its own slot, so the results need no lock
+        for(size_t i = 0; i < configs.size(); i++){
+            pool.submit([&, i]{ results[i] = run_one(configs[i], events); });
+        }
+        pool.wait();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(end - start).count();
+    for(size_t i = 0; i < configs.size(); i++){
+        if(!results[i].error.empty()) std::cerr << "Error: Configuration " << (i + 1) << ": " << results[i].error << "\n";
+    }
+
+    if(out_path.empty()){
+        write_csv(std::cout, configs, results);
+        return true;
+    }
+    std::ofstream out(out_path);
+    if(!out){
+        std::cerr << "Error: Cannot write " << out_path << "\n";
+        return false;
+    }
+    write_csv(out, configs, results);
+    std::cout << "Swept " << configs.size() << " configurations of " << events.size() << " events on "
+              << pool_threads << " threads in " << std::fixed << std::setprecision(3) << elapsed
+              << " s -> " << out_path << "\n";
+    return true;
+}
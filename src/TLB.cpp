@@ -0,0 +1,118 @@
+#include "../include/TLB.hpp"
+
+TLB::TLB(size_t entry_count, size_t assoc, const std::string& policy_str, bool asid)
+    : num_entries(entry_count), associativity(assoc), asid_tagging(asid) {
+    if(entry_count == 0 || assoc == 0 || entry_count % assoc != 0){
+        std::cerr << "Error: Invalid TLB Configuration, using 16 entries 4-way\n";
+        num_entries = 16;
+        associativity = 4;
+    }
+    num_sets = num_entries / associativity;
+
+    if(policy_str == "fifo") policy = Policy::FIFO;
+    else if(policy_str == "random") policy = Policy::Random;
+    else policy = Policy::LRU;
+    policy_name = (policy == Policy::FIFO) ? "FIFO" : (policy == Policy::Random) ? "Random" : "LRU";
+
+    entries.assign(num_entries, {0, -1, -1, false});
+    stamps.assign(num_entries, 0);
+}
+
+bool TLB::valid_config(size_t entries, size_t assoc, const std::string& policy){
+    if(entries == 0 || assoc == 0 || entries % assoc != 0) return false;
+    return policy == "lru" || policy == "fifo" || policy == "random";
+}
+
+TLB::Entry* TLB::find(int pid, size_t page){
+    size_t base = (page % num_sets) * associativity;
+    for(size_t i = base; i < base + associativity; i++){
+        Entry& entry = entries[i];
+        // Entries always record their PID; without ASID tagging they all
+        // belong to the current PID anyway, since a switch flushes them
+        if(entry.valid && entry.page == page && entry.asid == pid){
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+int TLB::lookup(int pid, size_t page){
+    // Without ASIDs, a context switch makes every cached translation stale
+    if(!asid_tagging && pid != current_asid){
+        if(current_asid != -1) flush();
+        current_asid = pid;
+    }
+
+    Entry* entry = find(pid, page);
+    if(entry){
+        hits++;
+        if(policy == Policy::LRU) stamps[entry - entries.data()] = ++tick;
+        return entry->frame;
+    }
+    misses++;
+    return -1;
+}
+
+void TLB::insert(int pid, size_t page, int frame){
+    Entry* existing = find(pid, page);
+    if(existing){
+        existing->frame = frame;
+        return;
+    }
+
+    size_t base = (page % num_sets) * associativity;
+    size_t victim = base;
+    bool found_empty = false;
+    for(size_t i = base; i < base + associativity; i++){
+        if(!entries[i].valid){
+            victim = i;
+            found_empty = true;
+            break;
+        }
+    }
+    if(!found_empty){
+        if(policy == Policy::Random){
+            rng_state ^= rng_state << 13;
+            rng_state ^= rng_state >> 17;
+            rng_state ^= rng_state << 5;
+            victim = base + rng_state % associativity;
+        } else {
+            //Oldest stamp: least recently used (LRU) or first filled (FIFO)
+            for(size_t i = base + 1; i < base + associativity; i++){
+                if(stamps[i] < stamps[victim]) victim = i;
+            }
+        }
+    }
+
+    entries[victim] = {page, frame, pid, true};
+    stamps[victim] = ++tick;
+}
+
+void TLB::invalidate(int pid, size_t page){
+    Entry* entry = find(pid, page);
+    if(entry){
+        entry->valid = false;
+        shootdowns++;
+    }
+}
+
+void TLB::invalidate_pid(int pid){
+    for(auto& entry : entries){
+        if(entry.valid && entry.asid == pid) entry.valid = false;
+    }
+}
+
+void TLB::flush(){
+    for(auto& entry : entries) entry.valid = false;
+    flushes++;
+}
+
+void TLB::display_stats(){
+    long long total = hits + misses;
+    double ratio = (total == 0) ? 0.0 : (double)hits / total * 100.0;
+    std::cout << "Entries: " << num_entries << " | Assoc: " << associativity << "-way | " << policy_name
+              << (asid_tagging ? " | ASID" : " | Flush on switch")
+              << " | Hits: " << hits << " | Misses: " << misses
+              << " | Hit Ratio: " << std::fixed << std::setprecision(2) << ratio << "%"
+              << " | Shootdowns: " << shootdowns << " | Flushes: " << flushes << "\n";
+}
@@ -0,0 +1,82 @@
+#include "../include/ThreadPool.hpp"
+
+ThreadPool::ThreadPool(size_t thread_count){
+    if(thread_count == 0) thread_count = std::thread::hardware_concurrency();
+    if(thread_count == 0) thread_count = 1;
+
+    for(size_t i = 0; i < thread_count; i++) workers.push_back(new Worker());
+    for(size_t i = 0; i < thread_count; i++) threads.emplace_back(&ThreadPool::run, this, i);
+}
+
+ThreadPool::~ThreadPool(){
+    wait();
+    {
+        std::lock_guard<std::mutex> guard(state_lock);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for(std::thread& thread : threads) thread.join();
+    for(Worker* worker : workers) delete worker;
+}
+
+void ThreadPool::submit(std::function<void()> task){
+    unfinished++;
+    Worker* worker = workers[next_worker];
+    next_worker = (next_worker + 1) % workers.size();
+    {
+        std::lock_guard<std::mutex> guard(worker->lock);
+        worker->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> guard(state_lock);
+        queued++;
+    }
+    work_ready.notify_one();
+}
+
+bool ThreadPool::take(size_t self, std::function<void()>& task){
+    {
+        Worker* own = workers[self];
+        std::lock_guard<std::mutex> guard(own->lock);
+        if(!own->tasks.empty()){
+            task = std::move(own->tasks.back());
+            own->tasks.pop_back();
+            return true;
+        }
+    }
+    for(size_t i = 1; i < workers.size(); i++){
+        Worker* victim = workers[(self + i) % workers.size()];
+        std::lock_guard<std::mutex> guard(victim->lock);
+        if(!victim->tasks.empty()){
+            task = std::move(victim->tasks.front());
+            victim->tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(size_t self){
+    std::function<void()> task;
+    while(true){
+        if(take(self, task)){
+            queued--;
+            task();
+            task = nullptr;
+            if(--unfinished == 0){
+                std::lock_guard<std::mutex> guard(state_lock);
+                all_done.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(state_lock);
+        work_ready.wait(guard, [this]{ return queued > 0 || stopping; });
+        if(stopping && queued == 0) return;
+    }
+}
+
+void ThreadPool::wait(){
+    std::unique_lock<std::mutex> guard(state_lock);
+    all_done.wait(guard, [this]{ return unfinished == 0; });
+}
@@ -0,0 +1,164 @@
+#include "../include/TraceFile.hpp"
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const size_t WRITE_BUFFER_SIZE = 1 << 20;
+
+TraceWriter::TraceWriter(bool delta_encoded) : delta(delta_encoded) {
+    buffer.reserve(WRITE_BUFFER_SIZE);
+}
+
+TraceWriter::~TraceWriter(){
+    close();
+}
+
+bool TraceWriter::open(const std::string& path){
+    file = std::fopen(path.c_str(), "wb");
+    if(!file) return false;
+
+    // Placeholder header, rewritten with the real count on close()
+    TraceHeader header{};
+    std::fwrite(&header, sizeof(header), 1, file);
+    return true;
+}
+
+void TraceWriter::put(const void* record, size_t size){
+    const uint8_t* bytes = static_cast<const uint8_t*>(record);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+    if(buffer.size() >= WRITE_BUFFER_SIZE){
+        std::fwrite(buffer.data(), 1, buffer.size(), file);
+        buffer.clear();
+    }
+    count++;
+}
+
+void TraceWriter::put_delta(uint8_t op, int pid, int64_t value){
+    if(value < INT32_MIN || value > INT32_MAX){
+        DeltaTraceRecord extend{TRACE_OP_EXTEND, 0, 0xFFFF, (int32_t)(uint32_t)((uint64_t)value >> 32)};
+        put(&extend, sizeof(extend));
+    }
+    DeltaTraceRecord record{op, 0, (uint16_t)(pid == -1 ? 0xFFFF : pid), (int32_t)(uint32_t)value};
+    put(&record, sizeof(record));
+}
+
+bool TraceWriter::write(const TraceEvent& event){
+    if(!file) return false;
+
+    if(!delta){
+        TraceRecord record{};
+        record.op = static_cast<uint8_t>(event.op);
+        record.pid = event.pid;
+        record.size = event.size;
+        record.address = event.address;
+        put(&record, sizeof(record));
+        return true;
+    }
+
+    if(event.pid < -1 || event.pid >= 0xFFFF) return false;
+    if(has_address(event.op)){
+        put_delta(static_cast<uint8_t>(event.op), event.pid, (int64_t)(event.address - previous_address));
+        previous_address = event.address;
+    } else {
+        put_delta(static_cast<uint8_t>(event.op), event.pid, (int64_t)event.size);
+    }
+    return true;
+}
+
+bool TraceWriter::close(){
+    if(!file) return true;
+    std::fwrite(buffer.data(), 1, buffer.size(), file);
+    buffer.clear();
+
+    TraceHeader header{};
+    std::memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header.version = TRACE_VERSION;
+    header.record_size = delta ? sizeof(DeltaTraceRecord) : sizeof(TraceRecord);
+    header.flags = delta ? TRACE_FLAG_DELTA : 0;
+    header.record_count = count;
+    std::fseek(file, 0, SEEK_SET);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+    ok = (std::fclose(file) == 0) && ok;
+    file = nullptr;
+    return ok;
+}
+
+MappedTrace::~MappedTrace(){
+    close();
+}
+
+bool MappedTrace::is_binary_trace(const std::string& path){
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(TRACE_MAGIC)];
+    if(!in.read(magic, sizeof(magic))) return false;
+    return std::memcmp(magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0;
+}
+
+bool MappedTrace::open(const std::string& path){
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(TraceHeader)){
+        ::close(fd);
+        return false;
+    }
+    length = info.st_size;
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if(mapping == MAP_FAILED){
+        length = 0;
+        return false;
+    }
+    madvise(mapping, length, MADV_SEQUENTIAL);
+
+    data = static_cast<const uint8_t*>(mapping);
+    header = reinterpret_cast<const TraceHeader*>(data);
+
+    // Reject files that are not ours or are truncated
+    size_t record_size = is_delta() ? sizeof(DeltaTraceRecord) : sizeof(TraceRecord);
+    if(std::memcmp(header->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 ||
+       header->version != TRACE_VERSION || header->record_size != record_size ||
+       header->record_count > (length - sizeof(TraceHeader)) / record_size){
+        close();
+        return false;
+    }
+    rewind();
+    return true;
+}
+
+void MappedTrace::close(){
+    if(data) munmap(const_cast<uint8_t*>(data), length);
+    data = nullptr;
+    header = nullptr;
+    length = 0;
+}
+
+void MappedTrace::rewind(){
+    position = 0;
+    previous_address = 0;
+}
+
+long long convert_text_trace(const std::string& text_path, const std::string& binary_path, bool delta){
+    std::ifstream in(text_path);
+    if(!in) return -1;
+
+    TraceWriter writer(delta);
+    if(!writer.open(binary_path)) return -1;
+
+    std::string line;
+    TraceEvent event;
+    long long written = 0;
+    while(std::getline(in, line)){
+        if(!TraceReplayer::parse_line(line, event)) continue;
+        if(!writer.write(event)) return -1;
+        written++;
+    }
+    if(!writer.close()) return -1;
+    return written;
+}
@@ -0,0 +1,508 @@
+#include "../include/TraceReplayer.hpp"
+#include "../include/TraceFile.hpp"
+#include "../include/ThreadPool.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <sys/resource.h>
+
+static const char* STRATEGY_NAMES[] = {"First Fit", "Best Fit", "Worst Fit", "Buddy", "Slab"};
+static const char* STRATEGY_ARGS[] = {"first_fit", "best_fit", "worst_fit", "buddy", "slab"};
+static const int STRATEGY_COUNT = 5;
+static const char* PAGE_POLICIES[] = {"fifo", "lru", "clock", "second_chance", "ws", "opt"};
+static const int PAGE_POLICY_COUNT = 6;
+
+TraceReplayer::TraceReplayer(size_t ram_size) : initial_ram(ram_size) {
+    sim = new MemoryManager(ram_size);
+    sim->set_verbose(false);
+    if(ram_size < sim->get_page_size()) error = page_size_error(sim->get_page_size(), ram_size);
+}
+
+TraceReplayer::~TraceReplayer(){
+    delete sim;
+    delete sharded;
+}
+
+int TraceReplayer::strategy_id(const std::string& name){
+    for(int i = 0; i < STRATEGY_COUNT; i++){
+        if(name == STRATEGY_ARGS[i]) return i;
+    }
+    return -1;
+}
+
+const char* TraceReplayer::strategy_name(size_t id){
+    return (id < (size_t)STRATEGY_COUNT) ? STRATEGY_NAMES[id] : STRATEGY_NAMES[0];
+}
+
+int TraceReplayer::page_policy_id(const std::string& name){
+    for(int i = 0; i < PAGE_POLICY_COUNT; i++){
+        if(name == PAGE_POLICIES[i]) return i;
+    }
+    return -1;
+}
+
+const char* TraceReplayer::page_policy_name(size_t id){
+    return (id < (size_t)PAGE_POLICY_COUNT) ? PAGE_POLICIES[id] : PAGE_POLICIES[0];
+}
+
+void TraceReplayer::set_caches(const std::vector<CacheLevelConfig>& levels, CacheInclusion inclusion){
+    cache_levels = levels;
+    cache_inclusion = inclusion;
+    sim->configure_caches(cache_levels, cache_inclusion);
+}
+
+bool TraceReplayer::set_cores(size_t count, const std::string& policy, size_t quantum){
+    if(!sim->set_cores(count, policy, quantum)) return false;
+    cores = count;
+    scheduler_policy = policy;
+    scheduler_quantum = quantum;
+    return true;
+}
+
+void TraceReplayer::set_ram_size(size_t bytes){
+    ram_size = bytes;
+}
+
+bool TraceReplayer::set_strategy(const std::string& name){
+    int id = strategy_id(name);
+    if(id == -1) return false;
+    strategy = strategy_name(id);
+    sim->set_strategy(strategy);
+    return true;
+}
+
+//Only the shape is checked here: whether it fits is up to the RAM of each init
+bool TraceReplayer::set_page_size(size_t bytes){
+    if(bytes < 16 || (bytes & (bytes - 1)) != 0) return false;
+    page_size = bytes;
+    //Events before the first init run on the initial MemoryManager
+    error = sim->set_page_size(bytes) ? "" : page_size_error(bytes, initial_ram);
+    return true;
+}
+
+std::string TraceReplayer::page_size_error(size_t bytes, size_t ram){
+    return "Page size " + std::to_string(bytes) + " exceeds the " + std::to_string(ram) + " bytes of RAM";
+}
+
+bool TraceReplayer::set_sampling(const std::string& path, size_t every){
+    if(!sampler.open(path, every)) return false;
+    sim->set_sampler(&sampler);
+    return true;
+}
+
+void TraceReplayer::set_profile(const std::string& path){
+    profile_path = path;
+    sim->set_profiling(true);
+}
+
+void TraceReplayer::set_compaction(size_t budget, double threshold){
+    compact_budget = budget;
+    compact_threshold = threshold;
+    sim->set_compaction(budget, threshold);
+}
+
+void TraceReplayer::set_private_spaces(bool enabled){
+    private_spaces = enabled;
+    sim->set_private_spaces(enabled);
+}
+
+bool TraceReplayer::set_shards(size_t count, size_t threads){
+    if(count == 0) return false;
+    shards = count;
+    shard_threads = threads;
+    return true;
+}
+
+bool TraceReplayer::set_swap(const std::string& path){
+    if(!sim->set_swap(path)) return false;
+    swap_path = path;
+    return true;
+}
+
+bool TraceReplayer::set_page_policy(const std::string& name){
+    if(page_policy_id(name) == -1) return false;
+    page_policy = name;
+    sim->set_page_policy(name);
+    return true;
+}
+
+//Reads one unsigned number and advances p past it; false if none is there
+static bool read_number(const char*& p, int base, size_t& value){
+    while(*p == ' ' || *p == '\t') p++;
+    char* end;
+    value = std::strtoull(p, &end, base);
+    if(end == p) return false;
+    p = end;
+    return true;
+}
+
+bool TraceReplayer::parse_line(const std::string& line, TraceEvent& event){
+    const char* p = line.c_str();
+    while(*p == ' ' || *p == '\t') p++;
+    const char* word = p;
+    while(*p && *p != ' ' && *p != '\t' && *p != '\r') p++;
+    std::string command(word, p - word);
+
+    event = {TraceOp::Stats, -1, 0, 0};
+    size_t pid;
+
+    if(command == "malloc"){
+        event.op = TraceOp::Malloc;
+        if(!read_number(p, 10, event.size) || !read_number(p, 10, pid)) return false;
+        event.pid = (int)pid;
+    }
+    else if(command == "free"){
+        event.op = TraceOp::Free;
+        if(!read_number(p, 10, pid)) return false;
+        event.pid = (int)pid;
+        if(read_number(p, 16, event.address)) event.op = TraceOp::FreeAddr;
+    }
+    else if(command == "access" || command == "write"){
+        event.op = (command == "write") ? TraceOp::Write : TraceOp::Access;
+        if(!read_number(p, 10, pid) || !read_number(p, 16, event.address)) return false;
+        event.pid = (int)pid;
+    }
+    else if(command == "thread"){
+        event.op = TraceOp::Thread;
+        if(!read_number(p, 10, pid) || !read_number(p, 10, event.size)) return false;
+        event.pid = (int)pid;
+    }
+    else if(command == "init"){
+        event.op = TraceOp::Init;
+        if(!read_number(p, 10, event.size)) return false;
+    }
+    else if(command == "strategy"){
+        while(*p == ' ' || *p == '\t') p++;
+        const char* name = p;
+        while(*p && *p != ' ' && *p != '\t' && *p != '\r') p++;
+        int id = strategy_id(std::string(name, p - name));
+        if(id == -1) return false;
+        event.op = TraceOp::Strategy;
+        event.size = id;
+    }
+    else if(command == "page_policy"){
+        while(*p == ' ' || *p == '\t') p++;
+        const char* name = p;
+        while(*p && *p != ' ' && *p != '\t' && *p != '\r') p++;
+        int id = page_policy_id(std::string(name, p - name));
+        if(id == -1) return false;
+        event.op = TraceOp::PagePolicy;
+        event.size = id;
+    }
+    else if(command == "stats") event.op = TraceOp::Stats;
+    else if(command == "dump") event.op = TraceOp::Dump;
+    else if(command == "exit") event.op = TraceOp::Exit;
+    else return false;
+
+    return true;
+}
+
+bool TraceReplayer::setup(MemoryManager* target, std::string& problem) const{
+    problem.clear();
+    if(!strategy.empty()) target->set_strategy(strategy);
+    //The default page has to fit as much as a requested one
+    if((page_size && !target->set_page_size(page_size)) || target->get_ram_size() < target->get_page_size()){
+        problem = page_size_error(page_size ? page_size : target->get_page_size(), target->get_ram_size());
+        return false;
+    }
+    if(!page_policy.empty()) target->set_page_policy(page_policy);
+    if(cores > 1) target->set_cores(cores, scheduler_policy, scheduler_quantum);
+    if(!cache_levels.empty()) target->configure_caches(cache_levels, cache_inclusion);
+    if(compact_budget) target->set_compaction(compact_budget, compact_threshold);
+    if(private_spaces) target->set_private_spaces(true);
+    return true;
+}
+
+bool TraceReplayer::apply(const TraceEvent& event){
+    if(event.op != TraceOp::Init) return error.empty() && apply_event(sim, event, counts);
+
+    sim->write_sample(); // the state the segment ended in
+    delete sim;
+    sim = new MemoryManager(ram_size ? ram_size : event.size);
+    sim->set_verbose(false);
+    if(!setup(sim, error)) return false;
+    if(!swap_path.empty()) sim->set_swap(swap_path);
+    if(!profile_path.empty()) sim->set_profiling(true);
+    if(sampler.is_open()) sim->set_sampler(&sampler);
+    return true;
+}
+
+bool TraceReplayer::apply_event(MemoryManager* target, const TraceEvent& event, ReplayCounts& tally) const{
+    switch(event.op){
+        case TraceOp::Malloc:
+            tally.mallocs++;
+            if(target->allocate(event.size, event.pid) == -1) tally.failed_mallocs++;
+            break;
+        case TraceOp::Free:
+            tally.frees++;
+            target->deallocate(event.pid);
+            break;
+        case TraceOp::FreeAddr:
+            tally.frees++;
+            target->deallocate(event.pid, event.address);
+            break;
+        case TraceOp::Access:
+            tally.accesses++;
+            target->access_memory(event.address, event.pid);
+            break;
+        case TraceOp::Write:
+            tally.accesses++;
+            tally.writes++;
+            target->access_memory(event.address, event.pid, true);
+            break;
+        case TraceOp::Thread:
+            target->add_thread(event.pid, (int)event.size);
+            break;
+        case TraceOp::Strategy:
+            if(strategy.empty()) target->set_strategy(strategy_name(event.size));
+            break;
+        case TraceOp::PagePolicy:
+            target->set_page_policy(page_policy_name(event.size));
+            break;
+        case TraceOp::Init: // handled by the caller
+        case TraceOp::Stats:
+        case TraceOp::Dump:
+            break; // Only the final state is reported
+        case TraceOp::Exit:
+            return false;
+    }
+    return true;
+}
+
+bool TraceReplayer::replay_text(const std::string& path){
+    std::ifstream in(path);
+    if(!in) return false;
+
+    auto start = std::chrono::steady_clock::now();
+    std::string line;
+    TraceEvent event;
+    while(std::getline(in, line)){
+        if(!parse_line(line, event)) continue;
+        if(!apply(event)) break;
+    }
+    auto end = std::chrono::steady_clock::now();
+    elapsed_seconds += std::chrono::duration<double>(end - start).count();
+    return true;
+}
+
+bool TraceReplayer::replay_binary(const std::string& path){
+    MappedTrace trace;
+    if(!trace.open(path)) return false;
+
+    auto start = std::chrono::steady_clock::now();
+    TraceEvent event;
+    while(trace.next(event)){
+        if(!apply(event)) break;
+    }
+    auto end = std::chrono::steady_clock::now();
+    elapsed_seconds += std::chrono::duration<double>(end - start).count();
+    return true;
+}
+
+bool TraceReplayer::load_events(const std::string& path, std::vector<TraceEvent>& events){
+    TraceEvent event;
+    if(MappedTrace::is_binary_trace(path)){
+        MappedTrace trace;
+        if(!trace.open(path)) return false;
+        events.reserve(trace.record_count());
+        while(trace.next(event)) events.push_back(event);
+        return true;
+    }
+
+    std::ifstream in(path);
+    if(!in) return false;
+    std::string line;
+    while(std::getline(in, line)){
+        if(parse_line(line, event)) events.push_back(event);
+    }
+    return true;
+}
+
+struct PidPageHash{
+    size_t operator()(const std::pair<int, size_t>& key) const {
+        return std::hash<size_t>()(key.second * 0x9E3779B97F4A7C15ULL ^ (size_t)key.first);
+    }
+};
+
+void TraceReplayer::compute_lookahead(MemoryManager* target, const std::vector<TraceEvent>& events, size_t begin){
+    size_t page_size = target->get_page_size();
+
+    //Threads translate in their process's space, so their pages are the process's: follow
+    //the thread events with add_thread's rules and key each access by the owner
+    std::unordered_map<int, int> owner;  // thread -> process
+    std::unordered_set<int> holding;     // PIDs with blocks, which keep a private space of their own
+    bool private_spaces = target->has_private_spaces();
+    std::vector<std::pair<int, size_t>> pages; // (owner pid, page) of each access, in order
+    for(size_t i = begin; i < events.size(); i++){
+        const TraceEvent& event = events[i];
+        if(event.op == TraceOp::Init || event.op == TraceOp::Exit) break;
+        if(event.op == TraceOp::Malloc) holding.insert(event.pid);
+        else if(event.op == TraceOp::Free) holding.erase(event.pid);
+        else if(event.op == TraceOp::Thread){
+            int tid = event.pid, pid = (int)event.size;
+            if(tid == pid || owner.count(pid) || (private_spaces && holding.count(tid))) continue;
+            owner[tid] = pid;
+        }
+        else if(event.op == TraceOp::Access || event.op == TraceOp::Write){
+            auto found = owner.find(event.pid);
+            pages.push_back({(found == owner.end()) ? event.pid : found->second, event.address / page_size});
+        }
+    }
+
+    //Backward pass: remember where each page is seen next
+    std::vector<size_t> next_use(pages.size());
+    std::unordered_map<std::pair<int, size_t>, size_t, PidPageHash> seen;
+    for(size_t i = pages.size(); i-- > 0; ){
+        auto it = seen.find(pages[i]);
+        next_use[i] = (it == seen.end()) ? SIZE_MAX : it->second;
+        seen[pages[i]] = i;
+    }
+    target->set_lookahead(std::move(next_use));
+}
+
+bool TraceReplayer::replay(const std::string& path){
+    if(page_policy != "opt" && shards == 0){
+        if(MappedTrace::is_binary_trace(path)) return replay_binary(path);
+        return replay_text(path);
+    }
+
+    //OPT needs the future and sharding the whole segment, so the trace is loaded first
+    auto start = std::chrono::steady_clock::now();
+    std::vector<TraceEvent> events;
+    if(!load_events(path, events)) return false;
+    auto end = std::chrono::steady_clock::now();
+    elapsed_seconds += std::chrono::duration<double>(end - start).count(); // loading counts too
+    if(shards > 0) replay_sharded(events);
+    else replay_events(events);
+    return true;
+}
+
+void TraceReplayer::replay_events(const std::vector<TraceEvent>& events){
+    auto start = std::chrono::steady_clock::now();
+    bool opt = (page_policy == "opt");
+    if(opt) compute_lookahead(sim, events, 0);
+    for(size_t i = 0; i < events.size(); i++){
+        if(!apply(events[i])) break;
+        if(opt && events[i].op == TraceOp::Init) compute_lookahead(sim, events, i + 1);
+    }
+    auto end = std::chrono::steady_clock::now();
+    elapsed_seconds += std::chrono::duration<double>(end - start).count();
+}
+
+void TraceReplayer::replay_sharded(const std::vector<TraceEvent>& events){
+    auto start = std::chrono::steady_clock::now();
+    size_t ram = initial_ram;
+    size_t i = 0;
+    while(true){
+        //Every shard needs a frame of its own. The old shards go first, with their swap files
+        delete sharded;
+        sharded = nullptr;
+        size_t page = page_size ? page_size : sim->get_page_size();
+        size_t count = std::min(shards, std::max<size_t>(ram / page, 1));
+        sharded = new ShardedMemoryManager(ram, count);
+        for(size_t k = 0; k < count; k++){
+            sharded->configure_shard(k, [&](MemoryManager& target){
+                std::string problem;
+                if(!setup(&target, problem) && error.empty()) error = problem;
+                if(!swap_path.empty()) target.set_swap(swap_path + "." + std::to_string(k));
+            });
+        }
+        //Only a segment with events needs its settings (the trace usually starts with an init)
+        if(!error.empty() && i < events.size() && events[i].op != TraceOp::Init) break;
+        error.clear();
+
+        i = run_segment(events, i);
+        if(i == events.size() || events[i].op == TraceOp::Exit) break;
+        ram = ram_size ? ram_size : events[i].size; // an init starts the next segment
+        i++;
+    }
+    auto end = std::chrono::steady_clock::now();
+    elapsed_seconds += std::chrono::duration<double>(end - start).count();
+}
+
+size_t TraceReplayer::run_segment(const std::vector<TraceEvent>& events, size_t begin){
+    //Partition in trace order. Settings go to every shard; a thread goes where its
+    //process runs, and from then on its events follow it there
+    size_t count = sharded->shard_count();
+    std::vector<std::vector<TraceEvent>> streams(count);
+    size_t end = begin;
+    for(; end < events.size(); end++){
+        const TraceEvent& event = events[end];
+        if(event.op == TraceOp::Init || event.op == TraceOp::Exit) break;
+        if(event.op == TraceOp::Strategy || event.op == TraceOp::PagePolicy){
+            for(std::vector<TraceEvent>& stream : streams) stream.push_back(event);
+        }
+        else if(event.op == TraceOp::Thread){
+            int target = sharded->route_thread(event.pid, (int)event.size);
+            if(target != -1) streams[target].push_back(event);
+        }
+        else if(event.op != TraceOp::Stats && event.op != TraceOp::Dump){
+            streams[sharded->shard_of(event.pid)].push_back(event);
+        }
+    }
+
+    bool opt = (page_policy == "opt");
+    std::vector<ReplayCounts> tallies(count);
+    size_t threads = shard_threads ? shard_threads : std::max(1u, std::thread::hardware_concurrency());
+    ThreadPool pool(std::min(threads, count));
+    for(size_t k = 0; k < count; k++){
+        pool.submit([&, k]{
+            //A batch of events per lock acquisition
+            static const size_t BATCH = 64;
+            const std::vector<TraceEvent>& stream = streams[k];
+            if(opt) sharded->configure_shard(k, [&](MemoryManager& target){ compute_lookahead(&target, stream, 0); });
+            for(size_t first = 0; first < stream.size(); first += BATCH){
+                size_t last = std::min(stream.size(), first + BATCH);
+                sharded->run_on(k, [&](MemoryManager& target){
+                    for(size_t j = first; j < last; j++) apply_event(&target, stream[j], tallies[k]);
+                });
+            }
+        });
+    }
+    pool.wait();
+    shard_workers = pool.get_threads();
+
+    for(const ReplayCounts& tally : tallies){
+        counts.mallocs += tally.mallocs;
+        counts.frees += tally.frees;
+        counts.accesses += tally.accesses;
+        counts.writes += tally.writes;
+        counts.failed_mallocs += tally.failed_mallocs;
+    }
+    return end;
+}
+
+void TraceReplayer::report(){
+    if(sharded){
+        sharded->display_stats();
+    } else {
+        sim->write_sample(); // the final state ends the series
+        sim->display_stats();
+    }
+
+    size_t events = counts.mallocs + counts.frees + counts.accesses;
+    double throughput = (elapsed_seconds > 0) ? events / elapsed_seconds : 0.0;
+
+    std::cout << "\n=========== REPLAY SUMMARY ============\n";
+    std::cout << "Events:          " << events << " (malloc " << counts.mallocs << ", free " << counts.frees
+              << ", access " << counts.accesses << ", of which writes " << counts.writes << ")\n";
+    std::cout << "Failed Mallocs:  " << counts.failed_mallocs << "\n";
+    if(sharded) std::cout << "Shards:          " << sharded->shard_count() << " on " << shard_workers << " threads\n";
+    std::cout << "Elapsed:         " << std::fixed << std::setprecision(6) << elapsed_seconds << " s\n";
+    std::cout << "Throughput:      " << std::setprecision(0) << throughput << " events/sec\n";
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0) std::cout << "Peak RSS:        " << usage.ru_maxrss << " KB\n";
+    std::cout << "=======================================\n";
+
+    if(profile_path.empty()) return;
+    sim->display_profile();
+    if(sim->write_profile(profile_path)) std::cout << "Miss-ratio curves written to " << profile_path << "\n";
+    else std::cerr << "Error: Cannot write " << profile_path << "\n";
+}
@@ -0,0 +1,107 @@
+// Randomized invariant check of the multi-core cache hierarchy.
+// Usage: coherence_check [accesses] [seed]
+// Drives several hierarchies with random reads and writes from random cores over a
+// few lines, and after every access checks each line:
+//  - single writer / multiple readers: an L1 copy in Modified or Exclusive state is the
+//    only L1 copy of its line
+//  - inclusion (inclusive hierarchies): a line held by a level is held by every level below
+// Prints the first violation and exits with 1, or prints a summary and exits with 0.
+#include "../include/CacheHierarchy.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const size_t SPAN = 2048; // bytes touched: 128 L1 lines of 16B, several times the L1s
+
+struct Setup{
+    const char* name;
+    const char* levels;
+    size_t cores;
+};
+
+static const char* state_name(LineState state){
+    switch(state){
+        case LineState::Shared: return "S";
+        case LineState::Exclusive: return "E";
+        case LineState::Modified: return "M";
+        default: return "I";
+    }
+}
+
+static std::string hex(size_t value){
+    std::ostringstream out;
+    out << "0x" << std::hex << value;
+    return out.str();
+}
+
+// Empty string if every line of the span is fine
+static std::string check(const CacheHierarchy& caches, CacheInclusion mode, size_t line_size){
+    for(size_t address = 0; address < SPAN; address += line_size){
+        size_t holders = 0, owners = 0;
+        std::string states;
+        for(size_t core = 0; core < caches.core_count(); core++){
+            LineState state = caches.l1_state(core, address);
+            states += state_name(state);
+            if(state == LineState::Invalid) continue;
+            holders++;
+            if(state == LineState::Modified || state == LineState::Exclusive) owners++;
+        }
+        if(owners > 1 || (owners == 1 && holders > 1)){
+            return "SWMR broken at " + hex(address) + ", L1 states " + states;
+        }
+        if(mode != CacheInclusion::Inclusive) continue;
+        for(size_t level = 0; level + 1 < caches.level_count(); level++){
+            if(caches.holds(level, address) && !caches.holds(level + 1, address)){
+                return "inclusion broken at " + hex(address) + ": in L" + std::to_string(level + 1) +
+                       " but not in L" + std::to_string(level + 2);
+            }
+        }
+    }
+    return "";
+}
+
+int main(int argc, char* argv[]){
+    size_t accesses = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    unsigned long long seed = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 1;
+
+    const std::vector<Setup> setups = {
+        {"non-inclusive, 2 cores", "128:16:2:4 512:16:4:12", 2},
+        {"inclusive, 4 cores", "inclusive 128:16:2:4:lru 512:32:4:12:lru 1024:64:4:30", 4},
+        {"inclusive write-through L1, 4 cores", "inclusive 128:16:2:4:wt 512:16:4:12:srrip", 4},
+        {"non-inclusive write-through, 3 cores", "128:16:2:4:wt 256:16:2:12:wt 1024:16:4:30", 3},
+        {"inclusive with prefetchers, 4 cores", "inclusive 128:16:2:4:lru:next_line/2/1 512:16:4:12:lru:stream/4/8", 4},
+        {"non-inclusive with prefetchers, 2 cores", "128:16:2:4:plru:stride 512:16:4:12:next_line", 2},
+    };
+
+    std::mt19937_64 rng(seed);
+    for(const Setup& setup : setups){
+        std::vector<CacheLevelConfig> levels;
+        CacheInclusion mode;
+        if(!CacheHierarchy::parse_config(setup.levels, levels, mode) || !CacheHierarchy::valid_config(levels, mode)){
+            std::cout << "Coherence check: bad setup " << setup.levels << "\n";
+            return 1;
+        }
+        CacheHierarchy caches(levels, mode, 100, setup.cores);
+        for(size_t i = 0; i < accesses; i++){
+            //Mostly a small hot range, so cores keep meeting on the same lines
+            size_t range = (rng() % 4 == 0) ? SPAN : 256;
+            size_t address = rng() % range;
+            bool write = rng() % 3 == 0;
+            size_t core = rng() % setup.cores;
+            caches.access(address, write, core);
+
+            std::string problem = check(caches, mode, levels[0].block_size);
+            if(!problem.empty()){
+                std::cout << "Coherence check FAILED (" << setup.name << ") after access " << i << " ("
+                          << (write ? "write" : "read") << " " << hex(address)
+                          << " on core " << core << "): " << problem << "\n";
+                return 1;
+            }
+        }
+        std::cout << "Coherence check: " << setup.name << ": " << accesses << " accesses OK\n";
+    }
+    return 0;
+}
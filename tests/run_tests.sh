@@ -1,4 +1,121 @@
 #!/bin/bash
 echo "Running Stress Test..."
 ../memsim < test_stress.txt
+echo "Running Replay Test..."
+../memsim --replay test_stress.txt
+echo "Running Slab Strategy Test..."
+../memsim --replay test_stress.txt --strategy slab
+echo "Running Slab Exhausted Heap Test..."
+# One 16 B slab left: the last object must still be handed out, and two freed by PID 1
+# must reach PID 2 from PID 1's cache
+SLAB_TRACE=$(mktemp)
+{ echo "init 4096"; echo "malloc 64512 9"; for i in $(seq 64); do echo "malloc 16 1"; done
+  echo "free 1 fc00"; echo "free 1 fc10"; echo "malloc 16 2"; } > "$SLAB_TRACE"
+if ! ../memsim --replay "$SLAB_TRACE" --strategy slab | grep -q "^Failed Mallocs:  0$"; then
+    echo "FAILED: a slab malloc failed with free objects in the PID caches"
+    exit 1
+fi
+rm -f "$SLAB_TRACE"
+echo "Running Compaction Test..."
+../memsim --replay test_stress.txt --compact 256:10
+echo "Running Private Address Space Test..."
+../memsim --replay test_stress.txt --spaces private --strategy buddy
+echo "Running Swap Test..."
+SWAP_FILE=$(mktemp)
+../memsim --replay test_stress.txt --swap "$SWAP_FILE" --page-size 64
+echo "Running RAM Below One Page Test..."
+# The REPL keeps its old RAM, a replay stops with an error: neither may crash
+printf "init 100\nmalloc 10 1\naccess 1 0\nexit\n" | ../memsim > /dev/null || exit 1
+TINY_TRACE=$(mktemp)
+printf "init 100\nmalloc 10 1\naccess 1 0\n" > "$TINY_TRACE"
+../memsim --replay "$TINY_TRACE" > /dev/null 2>&1
+if [ $? -ne 1 ]; then
+    echo "FAILED: a replay with less RAM than a page did not stop with an error"
+    exit 1
+fi
+rm -f "$TINY_TRACE"
+echo "Running Sharded Replay Test..."
+../memsim --replay test_stress.txt --shards 4:2
+echo "Running Sharded Determinism Test..."
+# 8 PIDs of random mallocs, frees, reads and writes
+SHARD_TRACE=$(mktemp)
+awk 'BEGIN{srand(7); print "init 65536"; for(i = 0; i < 3000; i++){pid = int(rand() * 8) + 1; r = rand();
+    if(r < 0.1) print "malloc " (int(rand() * 900) + 16) " " pid; else if(r < 0.12) print "free " pid;
+    else printf "%s %d 0x%x\n", (rand() < 0.3 ? "write" : "access"), pid, int(rand() * 16384)}}' > "$SHARD_TRACE"
+# Wall-clock figures and lock contention vary from run to run
+simulated(){
+    grep -vE "^(Elapsed|Throughput|Peak RSS|Shards: .* threads)" | sed -E 's/ \([0-9.]+% contended\)//'
+}
+# The figures a plain and a sharded report share
+shared_figures(){
+    grep -E "^(Used|Free) Memory|^Utilization|Fragmentation|^Allocation|^Free Block|^Simulated Cycles|^Avg Memory|^Events|^Failed" "$1"
+    grep -oE "^Page Faults: [0-9]+ \| Evictions: [0-9]+ \([0-9]+ dirty\)|^Page Walks: [0-9]+ \| Avg Walk Depth: [0-9.]+" "$1"
+    sed -nE 's/^(TLB|L[0-9]+) .*(Hits: [0-9]+ \| Misses: [0-9]+ \| Hit Ratio: [0-9.]+%).*/\1 \2/p' "$1"
+}
+ONE_THREAD=$(mktemp)
+FOUR_THREADS=$(mktemp)
+../memsim --replay "$SHARD_TRACE" --shards 4:1 | simulated > "$ONE_THREAD"
+../memsim --replay "$SHARD_TRACE" --shards 4:4 | simulated > "$FOUR_THREADS"
+if ! diff "$ONE_THREAD" "$FOUR_THREADS"; then
+    echo "FAILED: --shards 4:1 and --shards 4:4 differ"
+    exit 1
+fi
+../memsim --replay "$SHARD_TRACE" --shards 1 > "$ONE_THREAD"
+../memsim --replay "$SHARD_TRACE" > "$FOUR_THREADS"
+if ! diff <(shared_figures "$ONE_THREAD") <(shared_figures "$FOUR_THREADS"); then
+    echo "FAILED: --shards 1 differs from a plain replay"
+    exit 1
+fi
+echo "Sharded replay matches across thread counts, and a plain replay with one shard"
+rm -f "$SHARD_TRACE" "$ONE_THREAD" "$FOUR_THREADS"
+echo "Running OPT Thread Test..."
+# The same accesses, issued by two threads of PID 1 and then by PID 1 itself, touch the
+# same pages: OPT must see them as one stream either way
+THREAD_TRACE=$(mktemp)
+PID_TRACE=$(mktemp)
+awk 'BEGIN{srand(5); print "init 2048"; print "thread 10 1"; print "thread 11 1"; print "malloc 60000 1";
+    for(i = 0; i < 4000; i++) printf "access %d 0x%x\n", (rand() < 0.5 ? 10 : 11), int(rand() * 20000)}' > "$THREAD_TRACE"
+sed -E 's/^access 1[01] /access 1 /' "$THREAD_TRACE" > "$PID_TRACE"
+if ! diff <(../memsim --replay "$THREAD_TRACE" --policy opt | grep "^Page Faults") \
+          <(../memsim --replay "$PID_TRACE" --policy opt | grep "^Page Faults"); then
+    echo "FAILED: OPT faults differ when a process's accesses come from its threads"
+    exit 1
+fi
+rm -f "$THREAD_TRACE" "$PID_TRACE"
+echo "Running Cache Hierarchy Test..."
+../memsim --replay test_stress.txt --caches "inclusive 128:16:2:4:wt 512:16:4:12:lru 2048:16:8:30:srrip"
+echo "Running Prefetch Test..."
+../memsim --replay test_stress.txt --caches "128:16:2:4:lru:next_line 512:16:4:12:lru:stream/4/16" --cores 2
+echo "Running Multi-core Test..."
+../memsim --replay test_stress.txt --cores 4:rr:2
+echo "Running Coherence Check..."
+./coherence_check || exit 1
+echo "Running Swap Check..."
+./swap_check || exit 1
+echo "Running Reuse Profile Test..."
+PROFILE_CSV=$(mktemp)
+../memsim --replay test_stress.txt --profile "$PROFILE_CSV"
+rm -f "$PROFILE_CSV"
+echo "Running Sampling Test..."
+SERIES_CSV=$(mktemp)
+../memsim --replay test_stress.txt --sample 4:"$SERIES_CSV" > /dev/null
+cat "$SERIES_CSV"
+rm -f "$SERIES_CSV"
+echo "Running JSON Stats Test..."
+STATS_JSON=$(mktemp)
+../memsim --replay test_stress.txt --stats-out "$STATS_JSON" > /dev/null
+cat "$STATS_JSON"
+rm -f "$STATS_JSON"
+echo "Running Page Size Check Test..."
+if ../memsim --replay test_stress.txt --page-size 2048 > /dev/null; then
+    echo "FAILED: a page larger than the trace's RAM was accepted"
+    exit 1
+fi
+echo "Running Sweep Test..."
+../memsim --sweep test_stress.txt sweep_grid.txt --threads 4
+echo "Running Binary Trace Test..."
+TRACE_BIN=$(mktemp)
+../memsim --convert test_stress.txt "$TRACE_BIN" --delta
+../memsim --replay "$TRACE_BIN"
+rm -f "$TRACE_BIN"
 echo "Test Complete."
@@ -0,0 +1,141 @@
+// Randomized byte check of paging through a swap file.
+// Usage: swap_check [operations] [seed]
+// Runs several small-RAM simulators with a swap file through random mallocs, frees,
+// writes and reads, with compaction moving the blocks under them. Every byte written is
+// remembered; every read (and a final pass over all of them) must give it back, after
+// however many evictions, page-ins and moves happened in between. The simulator's own
+// checksum errors must stay at 0.
+// Prints the first mismatch and exits with 1, or prints a summary and exits with 0.
+#include "../include/MemoryManager.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+static const char* SWAP_FILE = "swap_check.swp";
+
+struct Setup{
+    const char* name;
+    size_t ram;
+    size_t page_size;
+    const char* policy;
+    bool private_spaces;
+    size_t budget;        // incremental compaction, 0: none
+    size_t compact_every; // full passes, 0: none
+};
+
+struct Block{
+    int pid;
+    size_t address;
+    size_t size;
+};
+
+static std::string hex(size_t value){
+    std::ostringstream out;
+    out << "0x" << std::hex << value;
+    return out.str();
+}
+
+int main(int argc, char* argv[]){
+    size_t operations = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    unsigned long long seed = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 1;
+
+    const std::vector<Setup> setups = {
+        {"paging only, FIFO", 1024, 64, "fifo", false, 0, 0},
+        {"full compaction passes, LRU", 2048, 64, "lru", false, 0, 50},
+        {"incremental compaction, Clock", 2048, 64, "clock", false, 128, 0},
+        {"private spaces, compaction, WS", 2048, 128, "ws", true, 0, 40},
+        {"pages larger than blocks, compaction, Second-Chance", 4096, 512, "second_chance", false, 0, 30},
+    };
+
+    std::mt19937_64 rng(seed);
+    for(const Setup& setup : setups){
+        MemoryManager sim(setup.ram);
+        if(!sim.set_page_size(setup.page_size) || !sim.set_page_policy(setup.policy) ||
+           !sim.set_swap(SWAP_FILE) || !sim.set_private_spaces(setup.private_spaces)){
+            std::cout << "Swap check: bad setup (" << setup.name << ")\n";
+            return 1;
+        }
+        sim.set_verbose(false);
+        if(setup.budget) sim.set_compaction(setup.budget, 10.0);
+
+        std::vector<Block> blocks;
+        std::map<std::pair<int, size_t>, int> written; // (PID, address) -> byte
+        size_t reads = 0;
+        auto forget = [&](const Block& block){
+            written.erase(written.lower_bound({block.pid, block.address}),
+                          written.lower_bound({block.pid, block.address + block.size}));
+        };
+        auto check = [&](int pid, size_t address, int expected){
+            reads++;
+            int value = sim.peek(address, pid);
+            if(value == expected) return true;
+            std::cout << "Swap check FAILED (" << setup.name << "): PID " << pid << " read " << value
+                      << " at " << hex(address) << ", wrote " << expected << "\n";
+            return false;
+        };
+
+        for(size_t i = 0; i < operations; i++){
+            unsigned roll = rng() % 100;
+            if(blocks.empty() || roll < 8){
+                int pid = 1 + (int)(rng() % 4);
+                size_t size = 16 + rng() % 300;
+                long long address = sim.allocate(size, pid);
+                if(address < 0) continue;
+                //A block of the PID that compaction moved away from these addresses is
+                //only reachable at its new one now: stop following it
+                for(size_t j = blocks.size(); j-- > 0;){
+                    const Block& old = blocks[j];
+                    if(old.pid != pid || old.address >= (size_t)address + size || old.address + old.size <= (size_t)address) continue;
+                    forget(old);
+                    blocks.erase(blocks.begin() + j);
+                }
+                blocks.push_back({pid, (size_t)address, size});
+                continue;
+            }
+            size_t index = rng() % blocks.size();
+            Block block = blocks[index];
+            if(roll < 12){
+                sim.deallocate(block.pid, block.address);
+                forget(block);
+                blocks.erase(blocks.begin() + index);
+                continue;
+            }
+            //A handful of spots per block, so reads mostly find a byte written before
+            size_t address = block.address + (rng() % 8) * block.size / 8;
+            if(roll < 55){
+                sim.access_memory(address, block.pid, true);
+                int value = sim.peek(address, block.pid);
+                if(value < 0){
+                    std::cout << "Swap check FAILED (" << setup.name << "): PID " << block.pid
+                              << " could not read back " << hex(address) << "\n";
+                    return 1;
+                }
+                written[{block.pid, address}] = value;
+            } else {
+                auto found = written.find({block.pid, address});
+                if(found != written.end() && !check(block.pid, address, found->second)) return 1;
+            }
+            if(setup.compact_every && i % setup.compact_every == 0) sim.compact();
+        }
+        for(const auto& pair : written){
+            if(!check(pair.first.first, pair.first.second, pair.second)) return 1;
+        }
+
+        SimulationSummary summary = sim.summarize();
+        if(summary.swap_integrity_errors){
+            std::cout << "Swap check FAILED (" << setup.name << "): " << summary.swap_integrity_errors
+                      << " pages failed their checksum\n";
+            return 1;
+        }
+        const CompactionStats& moves = sim.get_compaction_stats();
+        std::cout << "Swap check: " << setup.name << ": " << reads << " reads OK (" << summary.page_faults
+                  << " page faults, " << summary.swap_bytes_read / setup.page_size
+                  << " pages read back, " << moves.blocks_moved << " blocks moved)\n";
+    }
+    return 0;
+}